@@ -0,0 +1,180 @@
+/*
+Benchmarks for the multiplication algorithms, shows where each tier
+crosses over the one below it, to help tuning the cutoffs.
+
+Each algorithm is run for a single level on top of the tier below it
+(using the configured cutoffs), so the crossover is the first size at
+which the faster column changes.
+
+Division runs whole algorithms (dividing 2n digits by n digits), the
+recursive division base case is set by BURNIKEL_ZIEGLER_CUTOFF and the
+Newton reciprocal base case by NEWTON_RECIPROCAL_CUTOFF (NEWTON_CUTOFF is
+where Newton division takes over from the recursive one).
+*/
+
+#define UINT_T_PUBLIC_IMPLEMENTATION
+#include "uinteger_t.hh"
+
+#include <chrono>
+#include <random>
+#include <iomanip>
+
+static std::mt19937_64 engine(0);
+
+static uinteger_t random_uint(std::size_t digits) {
+	std::string bytes;
+	bytes.reserve(digits * uinteger_t::digit_octets);
+	bytes.push_back('\x01');
+	for (std::size_t i = 1; i < digits * uinteger_t::digit_octets; ++i) {
+		bytes.push_back(static_cast<char>(engine()));
+	}
+	return uinteger_t(bytes, 256);
+}
+
+template <typename F>
+static double timeit(F&& fn) {
+	using clock = std::chrono::steady_clock;
+	std::size_t loops = 1;
+	while (true) {
+		auto start = clock::now();
+		for (std::size_t i = 0; i < loops; ++i) {
+			fn();
+		}
+		std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+		if (elapsed.count() > 100000 || loops >= (1 << 20)) {
+			return elapsed.count() / loops;
+		}
+		loops *= 2;
+	}
+}
+
+template <typename L, typename U>
+static void tier(const char* name, const char* lower_name, const char* upper_name, std::size_t min_digits, std::size_t max_digits, L&& lower, U&& upper, std::size_t upper_split) {
+	std::cout << name << std::endl;
+	std::cout << std::setw(8) << "bits" << std::setw(16) << lower_name << std::setw(16) << upper_name << std::endl;
+	for (auto digits = min_digits; digits <= max_digits; digits += digits / 4) {
+		auto lhs = random_uint(digits);
+		auto rhs = random_uint(digits);
+		uinteger_t result;
+		auto t_lower = timeit([&]{ lower(result, lhs, rhs); });
+		// A single level of the upper algorithm, pieces go to the lower one:
+		auto t_upper = timeit([&]{ upper(result, lhs, rhs, digits / upper_split + 1); });
+		std::cout << std::setw(8) << digits * uinteger_t::digit_bits
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_lower << "us"
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_upper << "us"
+			<< (t_upper < t_lower ? "  *" : "") << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+template <typename L, typename U>
+static void division_tier(const char* name, const char* lower_name, const char* upper_name, std::size_t min_digits, std::size_t max_digits, L&& lower, U&& upper) {
+	std::cout << name << std::endl;
+	std::cout << std::setw(8) << "bits" << std::setw(16) << lower_name << std::setw(16) << upper_name << std::endl;
+	for (auto digits = min_digits; digits <= max_digits; digits += digits / 4) {
+		auto lhs = random_uint(digits * 2);
+		auto rhs = random_uint(digits);
+		uinteger_t quotient, remainder;
+		auto t_lower = timeit([&]{ lower(quotient, remainder, lhs, rhs); });
+		auto t_upper = timeit([&]{ upper(quotient, remainder, lhs, rhs); });
+		std::cout << std::setw(8) << digits * uinteger_t::digit_bits
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_lower << "us"
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_upper << "us"
+			<< (t_upper < t_lower ? "  *" : "") << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+static void modular_tier() {
+	std::cout << "modular multiplication: (a * b) % n vs. barrett and montgomery" << std::endl;
+	std::cout << std::setw(8) << "bits" << std::setw(16) << "divmod" << std::setw(16) << "barrett" << std::setw(16) << "montgomery" << std::endl;
+	for (std::size_t digits = 16; digits <= 128; digits *= 2) {
+		auto modulus = random_uint(digits) | 1;
+		auto a = random_uint(digits) % modulus;
+		auto b = random_uint(digits) % modulus;
+		const barrett_context barrett(modulus);
+		const montgomery_context montgomery(modulus);
+		auto ma = montgomery.to_mont(a);
+		auto mb = montgomery.to_mont(b);
+		uinteger_t result;
+		auto t_divmod = timeit([&]{ result = (a * b) % modulus; });
+		auto t_barrett = timeit([&]{ barrett.mod_mul(result, a, b); });
+		auto t_montgomery = timeit([&]{ montgomery.mont_mul(result, ma, mb); });
+		std::cout << std::setw(8) << digits * uinteger_t::digit_bits
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_divmod << "us"
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_barrett << "us"
+			<< std::setw(14) << std::fixed << std::setprecision(1) << t_montgomery << "us" << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+int main() {
+	tier("long_mult vs. karatsuba_mult", "long", "karatsuba", 4, 64,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+			uinteger_t::long_mult(result, lhs, rhs);
+		},
+		uinteger_t::karatsuba_mult, 2);
+
+	tier("karatsuba_mult vs. toom3_mult", "karatsuba", "toom3", 32, 512,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+			uinteger_t::karatsuba_mult(result, lhs, rhs, KARATSUBA_CUTOFF / uinteger_t::digit_bits);
+		},
+		uinteger_t::toom3_mult, 3);
+
+	tier("toom3_mult vs. toom4_mult", "toom3", "toom4", 64, 2048,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+			uinteger_t::toom3_mult(result, lhs, rhs, TOOM3_CUTOFF / uinteger_t::digit_bits);
+		},
+		uinteger_t::toom4_mult, 4);
+
+	tier("toom4_mult vs. ntt_mult", "toom4", "ntt", 128, 4096,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+			uinteger_t::toom4_mult(result, lhs, rhs, TOOM4_CUTOFF / uinteger_t::digit_bits);
+		},
+		uinteger_t::ntt_mult, 2);
+
+	tier("long_sqr vs. karatsuba_sqr", "long", "karatsuba", 4, 128,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&) {
+			uinteger_t::long_sqr(result, lhs);
+		},
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&, std::size_t cutoff) {
+			uinteger_t::karatsuba_sqr(result, lhs, cutoff);
+		}, 2);
+
+	tier("karatsuba_sqr vs. toom3_sqr", "karatsuba", "toom3", 32, 512,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&) {
+			uinteger_t::karatsuba_sqr(result, lhs, KARATSUBA_SQR_CUTOFF / uinteger_t::digit_bits);
+		},
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&, std::size_t cutoff) {
+			uinteger_t::toom3_sqr(result, lhs, cutoff);
+		}, 3);
+
+	tier("toom3_sqr vs. toom4_sqr", "toom3", "toom4", 64, 2048,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&) {
+			uinteger_t::toom3_sqr(result, lhs, TOOM3_SQR_CUTOFF / uinteger_t::digit_bits);
+		},
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&, std::size_t cutoff) {
+			uinteger_t::toom4_sqr(result, lhs, cutoff);
+		}, 4);
+
+	tier("toom4_sqr vs. ntt_sqr", "toom4", "ntt", 128, 4096,
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&) {
+			uinteger_t::toom4_sqr(result, lhs, TOOM4_SQR_CUTOFF / uinteger_t::digit_bits);
+		},
+		[](uinteger_t& result, const uinteger_t& lhs, const uinteger_t&, std::size_t cutoff) {
+			uinteger_t::ntt_sqr(result, lhs, cutoff);
+		}, 2);
+
+	division_tier("knuth_divmod vs. burnikel_ziegler_divmod", "knuth", "bz", 16, 2048,
+		uinteger_t::knuth_divmod, uinteger_t::burnikel_ziegler_divmod);
+
+	division_tier("burnikel_ziegler_divmod vs. newton_divmod", "bz", "newton", 1024, 16384,
+		uinteger_t::burnikel_ziegler_divmod,
+		[](uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+			uinteger_t::newton_divmod(quotient, remainder, lhs, rhs);
+		});
+
+	modular_tier();
+
+	return 0;
+}
@@ -31,3 +31,40 @@ TEST(Assignment, all) {
 	EXPECT_EQ(u32_1, u32_2);
 	EXPECT_EQ(u64_1, u64_2);
 }
+
+TEST(Assignment, small_buffer) {
+	// Numbers on both sides of the digits kept without allocating:
+	std::vector<uinteger_t> values;
+	for (std::size_t bits : {0, 1, 64, 128, 255, 256, 257, 320, 1000, 5000}) {
+		values.push_back(bits ? (uinteger_t(1) << (bits - 1)) * 3 - 1 : uinteger_t(0));
+	}
+
+	for (const auto& lhs : values) {
+		for (const auto& rhs : values) {
+			auto copy = lhs;
+			copy = rhs;
+			EXPECT_EQ(copy, rhs);
+
+			auto moved = lhs;
+			auto tmp = rhs;
+			moved = std::move(tmp);
+			EXPECT_EQ(moved, rhs);
+
+			auto a = lhs, b = rhs;
+			std::swap(a, b);
+			EXPECT_EQ(a, rhs);
+			EXPECT_EQ(b, lhs);
+
+			a += b;
+			EXPECT_EQ(a, lhs + rhs);
+		}
+
+		auto self = lhs;
+		auto& ref = self;
+		self = ref;
+		EXPECT_EQ(self, lhs);
+
+		uinteger_t constructed(std::move(self));
+		EXPECT_EQ(constructed, lhs);
+	}
+}
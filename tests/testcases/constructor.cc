@@ -81,3 +81,167 @@ TEST(Constructor, big) {
 
 	EXPECT_EQ(uinteger_t(data, 256).str<std::vector<char>>(256), data);
 }
+
+// One digit at a time
+static uinteger_t naive_strtouint(const std::string& digits, int base) {
+	uinteger_t result;
+	for (const auto& c : digits) {
+		result = result * base + (c <= '9' ? c - '0' : c - 'a' + 10);
+	}
+	return result;
+}
+
+TEST(Constructor, string_chunks) {
+	// Around the chunk sizes (19 digits for base 10, 40 for base 3):
+	std::mt19937_64 engine(0x57a7);
+	for (const auto& base : {3, 10, 36}) {
+		std::string digits;
+		for (std::size_t len = 1; len <= 130; ++len) {
+			digits.push_back("0123456789abcdefghijklmnopqrstuvwxyz"[engine() % base]);
+			EXPECT_EQ(uinteger_t(digits, base), naive_strtouint(digits, base));
+		}
+	}
+	EXPECT_EQ(uinteger_t(std::string(100, '0') + "42"), 42);
+	EXPECT_EQ(uinteger_t(std::string(100, '0')), 0);
+	EXPECT_EQ(uinteger_t(""), 0);
+	EXPECT_THROW(uinteger_t("12345678901234567890-"), std::invalid_argument);
+	EXPECT_THROW(uinteger_t(std::string(5000, '1') + "-" + std::string(5000, '1')), std::invalid_argument);
+
+	// Long enough for the halves to be parsed separately:
+	for (const auto& k : {1000, 4096, 10007}) {
+		EXPECT_EQ(uinteger_t("1" + std::string(k, '0')), uinteger_t(10).pow(k));
+		EXPECT_EQ(uinteger_t(std::string(k, '9')), uinteger_t(10).pow(k) - 1);
+		EXPECT_EQ(uinteger_t(std::string(k, '0') + "7"), 7);
+	}
+	std::string digits;
+	for (std::size_t len = 0; len < 5000; ++len) {
+		digits.push_back(static_cast<char>('0' + engine() % 10));
+	}
+	EXPECT_EQ(uinteger_t(digits), naive_strtouint(digits, 10));
+	for (int i = 0; i < 4; ++i) {
+		digits += digits;
+	}
+	digits[0] = '1';
+	EXPECT_EQ(uinteger_t(digits).str(), digits);
+}
+
+// Stateful allocator, counting the digits it allocates
+template <typename T>
+struct counting_allocator {
+	using value_type = T;
+
+	static std::size_t default_count;
+	std::size_t* count;
+
+	counting_allocator() noexcept :
+		count(&default_count) { }
+
+	explicit counting_allocator(std::size_t* count) noexcept :
+		count(count) { }
+
+	template <typename U>
+	counting_allocator(const counting_allocator<U>& o) noexcept :
+		count(o.count) { }
+
+	T* allocate(std::size_t n) {
+		*count += n;
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept {
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	friend bool operator==(const counting_allocator& lhs, const counting_allocator& rhs) {
+		return lhs.count == rhs.count;
+	}
+
+	friend bool operator!=(const counting_allocator& lhs, const counting_allocator& rhs) {
+		return lhs.count != rhs.count;
+	}
+};
+
+template <typename T>
+std::size_t counting_allocator<T>::default_count = 0;
+
+TEST(Constructor, allocator) {
+	using counted_t = basic_uinteger_t<counting_allocator<uinteger_t::digit>>;
+
+	std::mt19937_64 engine(0xa110c);
+	auto random = [&](std::size_t digits) {
+		uinteger_t value;
+		for (std::size_t i = 0; i < digits; ++i) {
+			value = (value << 64) | engine();
+		}
+		return value;
+	};
+
+	// Big enough for Toom-3 and Burnikel-Ziegler division
+	const auto a = random(400), b = random(250);
+
+	std::size_t count = 0;
+	const counting_allocator<uinteger_t::digit> alloc(&count);
+	counted_t x(alloc), y(alloc);
+	x = counted_t(a.str(16), 16);
+	y = counted_t(b.str(16), 16);
+	EXPECT_TRUE(x.get_allocator() == alloc);
+	EXPECT_GT(count, 0u);
+
+	// Results and temporaries all come from the operands' allocator
+	const auto default_count = counting_allocator<uinteger_t::digit>::default_count;
+	count = 0;
+	const auto product = x * y;
+	const auto square = x * x;
+	const auto quotient = product / x;
+	const auto remainder = (product + 12345) % y;
+	const auto copy = x;
+	EXPECT_GT(count, 0u);
+	EXPECT_EQ(counting_allocator<uinteger_t::digit>::default_count, default_count);
+	EXPECT_TRUE(product.get_allocator() == alloc);
+	EXPECT_TRUE(copy.get_allocator() == alloc);
+
+	EXPECT_EQ(product.str(16), (a * b).str(16));
+	EXPECT_EQ(square.str(16), (a * a).str(16));
+	EXPECT_EQ(quotient, y);
+	EXPECT_EQ(remainder, 12345);
+	EXPECT_EQ(copy, x);
+
+	// And so do those of the modular and number theoretic functions
+	const counted_t modulus = (x >> 23000) | 1;
+	const counted_t exp = y >> 14000;
+	const counted_t mersenne = ((x * 0 + 1) << 607) - 1;
+	const auto big = x.pow(6), big2 = y.pow(9) * 12345;  // for the half GCD
+	const basic_montgomery_context<counting_allocator<uinteger_t::digit>> ctx(modulus);
+	std::vector<counted_t> values{x % mersenne, y % mersenne};
+	count = 0;
+	const auto power = x.powmod(exp, modulus);
+	const auto even_power = x.powmod(exp, modulus + 1);
+	const auto ctx_power = ctx.pow(y, exp);
+	const auto divisor = big.gcd(big2);
+	const auto root = x.isqrt();
+	const auto prime = mersenne.is_probable_prime();
+	counted_t::batch_invmod(values, mersenne);
+	EXPECT_GT(count, 0u);
+	EXPECT_EQ(counting_allocator<uinteger_t::digit>::default_count, default_count);
+	EXPECT_TRUE(power.get_allocator() == alloc);
+
+	const uinteger_t m(modulus.str(16), 16), e(exp.str(16), 16);
+	EXPECT_EQ(power.str(16), a.powmod(e, m).str(16));
+	EXPECT_EQ(even_power.str(16), a.powmod(e, m + 1).str(16));
+	EXPECT_EQ(ctx_power.str(16), b.powmod(e, m).str(16));
+	EXPECT_EQ(divisor.str(16), a.pow(6).gcd(b.pow(9) * 12345).str(16));
+	EXPECT_EQ(root.str(16), a.isqrt().str(16));
+	EXPECT_TRUE(prime);
+	const auto p = (uinteger_t(1) << 607) - 1;
+	EXPECT_EQ(values[0].str(16), (a % p).invmod(p).str(16));
+	EXPECT_EQ(values[1].str(16), (b % p).invmod(p).str(16));
+
+	// Numbers with different allocators can be moved and swapped
+	counted_t z(a.str(16), 16);
+	EXPECT_TRUE(z.get_allocator() != alloc);
+	z = std::move(x);
+	EXPECT_EQ(z, y * 0 + copy);
+	std::swap(z, y);
+	EXPECT_EQ(y, copy);
+	EXPECT_EQ(z.str(16), b.str(16));
+}
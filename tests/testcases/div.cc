@@ -1,6 +1,9 @@
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "uinteger_t.hh"
+#include "random_uint.hh"
 
 TEST(Arithmetic, divide) {
 	const uinteger_t big_val  (0xfedbca9876543210ULL);
@@ -39,3 +42,92 @@ TEST(External, divide) {
 	EXPECT_EQ(u32 /= val, (uint32_t) 0x163356bULL);
 	EXPECT_EQ(u64 /= val, (uint64_t) 0x163356b88ac0de0ULL);
 }
+
+TEST(Arithmetic, divide_large) {
+	std::mt19937_64 engine(0x5eed);
+
+	// Sizes (in digits) of divisor and quotient, large enough to go
+	// through the recursive division:
+	const std::size_t sizes[][2] = {
+		{3, 5}, {40, 40}, {40, 200}, {33, 100}, {65, 65}, {100, 37},
+		{129, 130}, {200, 1000}, {255, 255}, {301, 777}, {600, 2000},
+	};
+	for (const auto& size : sizes) {
+		auto b = random_uint(engine, size[0]);
+		auto q = random_uint(engine, size[1]);
+		auto r = random_uint(engine, size[0]) % b;
+		auto a = q * b + r;
+		EXPECT_EQ(a / b, q);
+		EXPECT_EQ(a % b, r);
+
+		// Exact division, and the remainder being divisor - 1:
+		EXPECT_EQ((q * b) / b, q);
+		EXPECT_EQ((q * b) % b, 0);
+		EXPECT_EQ((q * b + b - 1) % b, b - 1);
+
+		// Leading digits of the dividend equal to those of the divisor:
+		auto c = (b << (size[1] * 64)) - 1;
+		EXPECT_EQ(c / b, (uinteger_t(1) << (size[1] * 64)) - 1);
+		EXPECT_EQ(c % b, b - 1);
+	}
+
+	// All ones divisors hit the quotient estimates B^n - 1:
+	for (const auto& n : {40, 130, 256}) {
+		auto b = (uinteger_t(1) << (n * 64)) - 1;
+		auto q = (uinteger_t(1) << (3 * n * 64)) - 1;
+		auto a = q * b + b - 1;
+		EXPECT_EQ(a / b, q);
+		EXPECT_EQ(a % b, b - 1);
+	}
+}
+
+TEST(Arithmetic, divide_reciprocal) {
+	std::mt19937_64 engine(0x5eed);
+
+	const std::size_t sizes[][2] = {
+		{2, 3}, {3, 50}, {40, 40}, {257, 100}, {300, 300}, {600, 2000}, {1500, 1000},
+	};
+	for (const auto& size : sizes) {
+		auto b = random_uint(engine, size[0]);
+		auto reciprocal = b.reciprocal();
+		for (const auto& a : {random_uint(engine, size[1]), random_uint(engine, size[0] + size[1]), (b << (size[1] * 64)) - 1}) {
+			auto res = a.reciprocal_divmod(b, reciprocal);
+			EXPECT_EQ(res.first, a / b);
+			EXPECT_EQ(res.second, a % b);
+		}
+	}
+
+	EXPECT_THROW(uinteger_t(0).reciprocal(), std::domain_error);
+
+	// Big enough to go through Newton division:
+	auto b = random_uint(engine, 17000);
+	auto q = random_uint(engine, 17000);
+	auto r = random_uint(engine, 16999);
+	auto a = q * b + r;
+	EXPECT_EQ(a / b, q);
+	EXPECT_EQ(a % b, r);
+}
+
+TEST(Arithmetic, divide_divisor) {
+	std::mt19937_64 engine(0xd1);
+	for (const auto& value : {1ULL, 3ULL, 10ULL, 10000000000000000000ULL, 0x7fffffffffffffffULL, 0x8000000000000000ULL, 0xffffffffffffffffULL}) {
+		const uinteger_t::divisor d(value);
+		for (const auto& digits : {1, 2, 20, 300}) {
+			auto a = random_uint(engine, digits);
+			auto q = random_uint(engine, digits);
+			auto r = random_uint(engine, 1) % value;
+			a = q * value + r;
+
+			auto res = a.divmod(d);
+			EXPECT_EQ(res.first, q);
+			EXPECT_EQ(res.second, r);
+			EXPECT_EQ(a / d, q);
+			EXPECT_EQ(a % d, r);
+			a /= d;
+			EXPECT_EQ(a, q);
+		}
+		EXPECT_EQ(uinteger_t(0) / d, 0);
+		EXPECT_EQ(uinteger_t(0) % d, 0);
+	}
+	EXPECT_THROW(uinteger_t::divisor(0), std::domain_error);
+}
@@ -0,0 +1,111 @@
+#include <random>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "uinteger_t.hh"
+
+template <std::size_t Bits>
+static void against_uinteger_t(std::mt19937_64& engine) {
+	const auto modulus = uinteger_t(1) << Bits;
+	auto random = [&] {
+		uinteger_t value;
+		// (sometimes with fewer digits, or with all of them set)
+		auto digits = engine() % (Bits / 64 + 1);
+		for (std::size_t i = 0; i < digits; ++i) {
+			value = (value << 64) | (engine() % 4 ? engine() : ~0ULL);
+		}
+		return value;
+	};
+
+	for (int i = 0; i < 200; ++i) {
+		const auto a = random(), b = random();
+		const uint_t<Bits> x(a), y(b);
+		EXPECT_EQ(static_cast<uinteger_t>(x), a);
+		EXPECT_EQ(static_cast<uinteger_t>(x + y), (a + b) % modulus);
+		EXPECT_EQ(static_cast<uinteger_t>(x - y), (a + modulus - b) % modulus);
+		EXPECT_EQ(static_cast<uinteger_t>(x * y), (a * b) % modulus);
+		EXPECT_EQ(static_cast<uinteger_t>(-x), (modulus - a) % modulus);
+		EXPECT_EQ(static_cast<uinteger_t>(~x), modulus - 1 - a);
+		EXPECT_EQ(static_cast<uinteger_t>(x & y), a & b);
+		EXPECT_EQ(static_cast<uinteger_t>(x | y), a | b);
+		EXPECT_EQ(static_cast<uinteger_t>(x ^ y), a ^ b);
+		if (b) {
+			EXPECT_EQ(static_cast<uinteger_t>(x / y), a / b);
+			EXPECT_EQ(static_cast<uinteger_t>(x % y), a % b);
+		}
+		EXPECT_EQ(x < y, a < b);
+		EXPECT_EQ(x <= y, a <= b);
+		EXPECT_EQ(x > y, a > b);
+		EXPECT_EQ(x >= y, a >= b);
+		EXPECT_EQ(x == y, a == b);
+		EXPECT_EQ(x != y, a != b);
+		EXPECT_EQ(x.bits(), a.bits());
+		EXPECT_EQ(x.str(16), a.str(16));
+
+		auto n = static_cast<std::size_t>(engine() % (Bits + 10));
+		EXPECT_EQ(static_cast<uinteger_t>(x << n), (a << n) % modulus);
+		EXPECT_EQ(static_cast<uinteger_t>(x >> n), a >> n);
+	}
+}
+
+TEST(FixedWidth, arithmetic) {
+	std::mt19937_64 engine(0xf1ed);
+	against_uinteger_t<64>(engine);
+	against_uinteger_t<128>(engine);
+	against_uinteger_t<256>(engine);
+	against_uinteger_t<512>(engine);
+	against_uinteger_t<1024>(engine);
+}
+
+TEST(FixedWidth, wraparound) {
+	const auto max = std::numeric_limits<uint_t<256>>::max();
+	EXPECT_EQ(max, uint_t<256>(-1));
+	EXPECT_EQ(max + 1, 0);
+	EXPECT_EQ(uint_t<256>(0) - 1, max);
+	EXPECT_EQ(max * max, 1);
+	EXPECT_EQ(max.str(16), std::string(64, 'f'));
+	EXPECT_EQ(std::numeric_limits<uint_t<256>>::digits, 256);
+
+	auto value = max;
+	EXPECT_EQ(++value, 0);
+	EXPECT_EQ(value--, 0);
+	EXPECT_EQ(value, max);
+	EXPECT_EQ(--uint_t<128>(uint_t<128>(1) << 64), uint_t<128>(~0ULL));
+
+	EXPECT_EQ(uint_t<128>(uinteger_t(1) << 200), 0);
+	EXPECT_EQ(uint_t<128>("340282366920938463463374607431768211457"), 1);
+	EXPECT_EQ(static_cast<unsigned>(uint_t<128>(0x123456789ULL)), 0x23456789u);
+	EXPECT_FALSE(uint_t<128>());
+	EXPECT_TRUE(uint_t<128>(1) << 100);
+	EXPECT_EQ(3 * uint_t<128>(5) + 1, 16);
+
+	std::stringstream hex;
+	hex << std::hex << (uint_t<128>(0xfedcba9876543210ULL) << 64);
+	EXPECT_EQ(hex.str(), "fedcba98765432100000000000000000");
+}
+
+TEST(FixedWidth, constexpr) {
+	// The NIST P-256 prime, 2^256 - 2^224 + 2^192 + 2^96 - 1
+	constexpr auto p256 = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff_u256;
+	constexpr auto one = uint_t<256>(1);
+	static_assert(p256 == -(one << 224) + (one << 192) + (one << 96) - 1, "P-256 prime");
+	static_assert(p256.bits() == 256, "P-256 prime bits");
+	static_assert(p256 > (one << 255) && p256 < std::numeric_limits<uint_t<256>>::max(), "P-256 prime bounds");
+
+	static_assert(123456789012345678901234567890_u128 == uint_t<128>(12345678901234567890ULL) * 10000000000ULL + 1234567890, "decimal");
+	static_assert(0b1'0000'0000_u128 == 256 && 0777_u512 == 511 && 0_u128 == 0 && 1'000'000_u256 == 1000000, "prefixes and separators");
+	static_assert(0xffffffffffffffffffffffffffffffff_u128 * 0xffffffffffffffffffffffffffffffff_u128 == 1, "wraparound");
+	static_assert(((1_u1024 << 1000) >> 999) == 2 && (1_u1024 << 1000).bits() == 1001, "shifts");
+	static_assert(static_cast<std::uint64_t>(~0_u128 >> 64) == ~0ULL, "typecast");
+
+	EXPECT_EQ(p256.str(), "115792089210356248762697446949407573530086143415290314195533631308867097853951");
+
+	EXPECT_EQ(0x1'0000'0000'0000'0000'0000'0000'0000'0000_uint, uinteger_t(1) << 128);
+	EXPECT_EQ(123456789012345678901234567890123456789012345678901234567890_uint, uinteger_t("123456789012345678901234567890123456789012345678901234567890"));
+	EXPECT_EQ(0_uint, 0);
+
+	EXPECT_THROW(uint_t<64>::literal("0x1ffffffffffffffff", 19), std::out_of_range);
+	EXPECT_THROW(uint_t<64>::literal("09", 2), std::invalid_argument);
+	EXPECT_EQ(uint_t<64>::literal("0xffffffffffffffff", 18), ~0ULL);
+}
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <map>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -54,3 +56,238 @@ TEST(External, ostream) {
 	std::stringstream zero; zero << uinteger_t(0);
 	EXPECT_EQ(zero.str(), "0");
 }
+
+TEST(Function, str_large) {
+	for (const auto& k : {1, 18, 19, 20, 38, 57, 100}) {
+		auto power = uinteger_t(10).pow(k);
+		EXPECT_EQ(power.str(), "1" + std::string(k, '0'));
+		EXPECT_EQ((power - 1).str(), std::string(k, '9'));
+		EXPECT_EQ((power + 1).str(), "1" + std::string(k - 1, '0') + "1");
+	}
+	EXPECT_EQ((uinteger_t(1) << 200).str(), "1606938044258990275541962092341162602522202993782792835301376");
+	EXPECT_EQ((uinteger_t(3).pow(100)).str(3), "1" + std::string(100, '0'));
+
+	// Round trips:
+	uinteger_t value = 1;
+	for (int i = 0; i < 40; ++i) {
+		value = value * 0xfedcba9876543210ULL + i;
+	}
+	for (const auto& base : {3, 7, 10, 12, 36}) {
+		EXPECT_EQ(uinteger_t(value.str(base), base), value);
+	}
+}
+
+TEST(Function, str_divide_and_conquer) {
+	// Long runs of zeros (and nines) across the splits:
+	for (const auto& k : {1000, 4096, 10007}) {
+		auto power = uinteger_t(10).pow(k);
+		EXPECT_EQ(power.str(), "1" + std::string(k, '0'));
+		EXPECT_EQ((power - 1).str(), std::string(k, '9'));
+		EXPECT_EQ((power * 7 + 3).str(), "7" + std::string(k - 1, '0') + "3");
+	}
+	EXPECT_EQ((uinteger_t(36).pow(5000) * 35).str(36), "z" + std::string(5000, '0'));
+
+	// Round trips:
+	uinteger_t value = 1;
+	for (int i = 0; i < 1500; ++i) {
+		value = value * 0xfedcba9876543210ULL + i;
+	}
+	for (const auto& base : {3, 10, 36}) {
+		EXPECT_EQ(uinteger_t(value.str(base), base), value);
+	}
+
+	// Against the digit by digit conversion:
+	const uinteger_t::divisor ten(10);
+	std::string digits;
+	for (auto q = value; q; q /= ten) {
+		digits.push_back(static_cast<char>('0' + q % ten));
+	}
+	std::reverse(digits.begin(), digits.end());
+	EXPECT_EQ(value.str(), digits);
+}
+
+TEST(Function, radix_powers) {
+	uinteger_t value = 1;
+	for (int i = 0; i < 700; ++i) {
+		value = value * 0xfedcba9876543210ULL + i;
+	}
+	const auto decimal = value.str();
+	const auto base7 = value.str(7);
+
+	// Same results with the powers cached, cleared and shared between threads:
+	uinteger_t::clear_radix_powers();
+	EXPECT_EQ(value.str(), decimal);
+	EXPECT_EQ(uinteger_t(decimal), value);
+	uinteger_t::clear_radix_powers();
+	EXPECT_EQ(uinteger_t(decimal), value);
+	EXPECT_EQ(value.str(), decimal);
+
+	std::vector<std::thread> threads;
+	std::vector<int> matches(8);
+	for (std::size_t t = 0; t < matches.size(); ++t) {
+		threads.emplace_back([&, t] {
+			for (int i = 0; i < 5; ++i) {
+				if (t % 3 == 0) {
+					uinteger_t::clear_radix_powers();
+				}
+				auto base = t % 2 ? 10 : 7;
+				const auto& expected = t % 2 ? decimal : base7;
+				matches[t] += value.str(base) == expected && uinteger_t(expected, base) == value;
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(matches, std::vector<int>(8, 5));
+}
+
+TEST(Function, hex) {
+	EXPECT_EQ(uinteger_t(0).str(16), "0");
+	EXPECT_EQ(uinteger_t("0", 16), 0);
+	EXPECT_EQ(uinteger_t("", 16), 0);
+	EXPECT_EQ(uinteger_t("00000000000000000000000000000000000001", 16), 1);
+	EXPECT_EQ(uinteger_t("FEDCBA9876543210fedcba9876543210", 16).str(16), "fedcba9876543210fedcba9876543210");
+
+	// Every length, so all block sizes and leftovers are covered,
+	// against the bits written out one nibble at a time:
+	uinteger_t value = 0xf;
+	for (int i = 0; i < 300; ++i) {
+		std::string nibbles;
+		for (auto q = value; q; q >>= 4) {
+			nibbles.push_back("0123456789abcdef"[static_cast<int>(q & 0xf)]);
+		}
+		std::reverse(nibbles.begin(), nibbles.end());
+		EXPECT_EQ(value.str(16), nibbles);
+		EXPECT_EQ(uinteger_t(nibbles, 16), value);
+		value = (value << 4) | static_cast<unsigned>((i * 7) & 0xf);
+	}
+
+	// Invalid characters anywhere in a long string:
+	auto hex = value.str(16);
+	for (const auto& at : {0, 1, 20, 100, 200, 298}) {
+		for (const auto& c : {'g', 'G', '/', ':', '@', '`', ' ', '\xe6'}) {
+			auto invalid = hex;
+			invalid[at] = c;
+			EXPECT_THROW(uinteger_t(invalid, 16), std::invalid_argument);
+		}
+	}
+	try {
+		auto invalid = hex;
+		invalid[100] = 'x';
+		uinteger_t(invalid, 16);
+		FAIL();
+	} catch (const std::invalid_argument& e) {
+		EXPECT_EQ(std::string(e.what()), "Error: Not a digit in base 16: 'x' at " + std::to_string(hex.size() - 100));
+	}
+}
+
+TEST(Function, to_chars) {
+	uinteger_t value = 1;
+	for (int i = 0; i < 70; ++i) {
+		value = value * 0xfedcba9876543210ULL + i;
+	}
+	for (const auto& number : {uinteger_t(0), uinteger_t(1), uinteger_t(2216002924), value >> 3000, value}) {
+		for (int base = 2; base <= 36; ++base) {
+			const auto expected = number.str(base);
+			EXPECT_GE(number.max_chars(base), expected.size());
+			std::vector<char> buffer(expected.size() + 1, '#');
+			auto res = number.to_chars(buffer.data(), buffer.data() + buffer.size(), base);
+			EXPECT_EQ(res.ec, std::errc());
+			EXPECT_EQ(std::string(buffer.data(), res.ptr), expected);
+
+			// One character too short:
+			res = number.to_chars(buffer.data(), buffer.data() + expected.size() - 1, base);
+			EXPECT_EQ(res.ec, std::errc::value_too_large);
+			EXPECT_EQ(res.ptr, buffer.data() + expected.size() - 1);
+		}
+	}
+	EXPECT_EQ(value.max_chars(16), value.str(16).size());
+	EXPECT_EQ(value.max_chars(37), 0u);
+
+	char buffer[8];
+	auto res = value.to_chars(buffer, buffer + sizeof(buffer), 37);
+	EXPECT_EQ(res.ec, std::errc::invalid_argument);
+	EXPECT_EQ(res.ptr, buffer);
+}
+
+// Allocator that fails for more than 100 digits at once
+template <typename T>
+struct limited_allocator {
+	using value_type = T;
+
+	limited_allocator() noexcept { }
+
+	template <typename U>
+	limited_allocator(const limited_allocator<U>&) noexcept { }
+
+	T* allocate(std::size_t n) {
+		if (n > 100) {
+			throw std::bad_alloc();
+		}
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept {
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	friend bool operator==(const limited_allocator&, const limited_allocator&) {
+		return true;
+	}
+
+	friend bool operator!=(const limited_allocator&, const limited_allocator&) {
+		return false;
+	}
+};
+
+TEST(Function, from_chars) {
+	uinteger_t value = 1;
+	for (int i = 0; i < 70; ++i) {
+		value = value * 0xfedcba9876543210ULL + i;
+	}
+	for (int base = 2; base <= 36; ++base) {
+		const auto digits = value.str(base) + "?123";
+		uinteger_t parsed = 12345;
+		auto res = uinteger_t::from_chars(digits.data(), digits.data() + digits.size(), parsed, base);
+		EXPECT_EQ(res.ec, std::errc());
+		EXPECT_EQ(res.ptr, digits.data() + digits.size() - 4);
+		EXPECT_EQ(parsed, value);
+
+		// Stops at the first digit that doesn't belong to the base:
+		if (base > 2) {
+			res = uinteger_t::from_chars(digits.data(), digits.data() + digits.size() - 4, parsed, base - 1);
+			EXPECT_EQ(res.ec, res.ptr == digits.data() ? std::errc::invalid_argument : std::errc());
+			EXPECT_EQ(parsed, uinteger_t(std::string(digits.data(), res.ptr), base - 1) + (res.ptr == digits.data() ? value : 0));
+		}
+	}
+
+	uinteger_t parsed = 42;
+	const std::string upper = "FfZz";
+	auto res = uinteger_t::from_chars(upper.data(), upper.data() + upper.size(), parsed, 16);
+	EXPECT_EQ(res.ec, std::errc());
+	EXPECT_EQ(res.ptr, upper.data() + 2);
+	EXPECT_EQ(parsed, 255);
+
+	// No digits at all leaves the value alone:
+	const std::string none = "-1";
+	res = uinteger_t::from_chars(none.data(), none.data() + none.size(), parsed, 10);
+	EXPECT_EQ(res.ec, std::errc::invalid_argument);
+	EXPECT_EQ(res.ptr, none.data());
+	EXPECT_EQ(parsed, 255);
+	res = uinteger_t::from_chars(none.data(), none.data(), parsed, 10);
+	EXPECT_EQ(res.ec, std::errc::invalid_argument);
+	res = uinteger_t::from_chars(upper.data(), upper.data() + upper.size(), parsed, 1);
+	EXPECT_EQ(res.ec, std::errc::invalid_argument);
+	EXPECT_EQ(parsed, 255);
+
+	// And so does running out of memory:
+	using limited_t = basic_uinteger_t<limited_allocator<uinteger_t::digit>>;
+	limited_t limited(std::string(500, 'f'), 16);
+	const auto original = limited;
+	const std::string huge(5000, '7');
+	auto limited_res = limited_t::from_chars(huge.data(), huge.data() + huge.size(), limited, 10);
+	EXPECT_EQ(limited_res.ec, std::errc::not_enough_memory);
+	EXPECT_EQ(limited_res.ptr, huge.data());
+	EXPECT_EQ(limited, original);
+}
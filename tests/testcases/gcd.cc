@@ -0,0 +1,118 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "uinteger_t.hh"
+#include "random_uint.hh"
+
+// Euclid's algorithm, one division at a time
+static uinteger_t naive_gcd(uinteger_t a, uinteger_t b) {
+	while (b) {
+		auto r = a % b;
+		a = std::move(b);
+		b = std::move(r);
+	}
+	return a;
+}
+
+// Checks the cofactors returned by gcdext(), g is the greatest common
+// divisor if it divides both numbers and the congruences hold
+static void check_gcdext(const uinteger_t& a, const uinteger_t& b, bool naive = true) {
+	auto result = a.gcdext(b);
+	const auto& g = std::get<0>(result);
+	const auto& s = std::get<1>(result);
+	const auto& t = std::get<2>(result);
+	if (naive) {
+		EXPECT_EQ(g, naive_gcd(a, b));
+	} else {
+		EXPECT_EQ(g, a.gcd(b));
+		EXPECT_EQ(a % g, 0);
+		EXPECT_EQ(b % g, 0);
+	}
+	EXPECT_EQ(a * s % b, g % b);
+	EXPECT_EQ(b * t % a, g % a);
+	EXPECT_LT(s, b / g);
+	EXPECT_LT(t, a / g);
+}
+
+TEST(Arithmetic, gcd) {
+	EXPECT_EQ(uinteger_t(0).gcd(0), 0);
+	EXPECT_EQ(uinteger_t(0).gcd(5), 5);
+	EXPECT_EQ(uinteger_t(5).gcd(0), 5);
+	EXPECT_EQ(uinteger_t(12).gcd(18), 6);
+	EXPECT_EQ(uinteger_t(17).gcd(5), 1);
+	EXPECT_EQ(uinteger_t(0xffffffffffffffffULL).gcd(0xfffffffffffffffeULL), 1);
+	EXPECT_EQ((uinteger_t(3) << 100).gcd(uinteger_t(9) << 70), uinteger_t(3) << 70);
+
+	// Binary GCD, Lehmer and half GCD, with a common factor:
+	std::mt19937_64 engine(0x5eed);
+	for (const auto& sizes : {std::make_pair(1, 1), std::make_pair(1, 2), std::make_pair(2, 3), std::make_pair(3, 40), std::make_pair(20, 20), std::make_pair(100, 100), std::make_pair(20, 300), std::make_pair(300, 300), std::make_pair(200, 700)}) {
+		auto common = random_uint(engine, 2);
+		auto a = random_uint(engine, sizes.first) * common;
+		auto b = random_uint(engine, sizes.second) * common;
+		auto expected = naive_gcd(a, b);
+		EXPECT_EQ(a.gcd(b), expected);
+		EXPECT_EQ(b.gcd(a), expected);
+		EXPECT_EQ((a << 130).gcd(b << 130), expected << 130);
+	}
+
+	// Large enough for the half GCD to take over:
+	auto common = random_uint(engine, 3);
+	auto a = random_uint(engine, 2500);
+	auto b = random_uint(engine, 3000);
+	auto g = (a * common).gcd(b * common);
+	EXPECT_EQ(g % common, 0);
+	check_gcdext(a * common, b * common, false);
+
+	// Consecutive Fibonacci numbers (all quotients are one):
+	uinteger_t f0 = 0;
+	uinteger_t f1 = 1;
+	for (int i = 0; i < 30000; ++i) {
+		f0 += f1;
+		std::swap(f0, f1);
+	}
+	EXPECT_EQ(f0.gcd(f1), 1);
+	EXPECT_EQ((f0 * 6).gcd(f1 * 15), 15);  // F(30000) is a multiple of 15
+}
+
+TEST(Arithmetic, lcm) {
+	EXPECT_EQ(uinteger_t(0).lcm(5), 0);
+	EXPECT_EQ(uinteger_t(4).lcm(6), 12);
+	EXPECT_EQ(uinteger_t(7).lcm(7), 7);
+
+	std::mt19937_64 engine(0x1c3);
+	for (const auto& digits : {1, 5, 50}) {
+		auto common = random_uint(engine, digits);
+		auto a = random_uint(engine, digits) * common;
+		auto b = random_uint(engine, digits) * common;
+		EXPECT_EQ(a.lcm(b) * a.gcd(b), a * b);
+	}
+}
+
+TEST(Arithmetic, gcdext) {
+	EXPECT_EQ(uinteger_t(0).gcdext(5), std::make_tuple(uinteger_t(5), uinteger_t(0), uinteger_t(1)));
+	EXPECT_EQ(uinteger_t(5).gcdext(0), std::make_tuple(uinteger_t(5), uinteger_t(1), uinteger_t(0)));
+	EXPECT_EQ(uinteger_t(3).gcdext(5), std::make_tuple(uinteger_t(1), uinteger_t(2), uinteger_t(2)));
+	EXPECT_EQ(uinteger_t(240).gcdext(46), std::make_tuple(uinteger_t(2), uinteger_t(14), uinteger_t(47)));
+	check_gcdext(6, 3);
+	check_gcdext(3, 6);
+	check_gcdext(7, 7);
+
+	std::mt19937_64 engine(0xe47);
+	for (const auto& sizes : {std::make_pair(1, 1), std::make_pair(2, 3), std::make_pair(3, 40), std::make_pair(20, 20), std::make_pair(100, 100), std::make_pair(300, 300), std::make_pair(200, 700)}) {
+		auto a = random_uint(engine, sizes.first);
+		auto b = random_uint(engine, sizes.second);
+		check_gcdext(a, b);
+		check_gcdext(b, a);
+		auto common = random_uint(engine, 3);
+		check_gcdext(a * common, b * common);
+	}
+
+	uinteger_t f0 = 0;
+	uinteger_t f1 = 1;
+	for (int i = 0; i < 30000; ++i) {
+		f0 += f1;
+		std::swap(f0, f1);
+	}
+	check_gcdext(f1, f0);
+}
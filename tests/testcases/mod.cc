@@ -41,3 +41,38 @@ TEST(External, modulo) {
 	EXPECT_EQ(u32 %= val, (uint32_t) 0x249ULL);
 	EXPECT_EQ(u64 %= val, (uint64_t) 0xc7fULL);
 }
+
+TEST(Arithmetic, mod_small) {
+	const std::vector<uinteger_t::digit> divisors = {
+		1, 2, 3, 7, 10, 251, 65521, 4294967291ULL, 4294967296ULL,
+		0x7fffffffffffffffULL, 0x8000000000000000ULL, 0xfedcba9876543210ULL,
+		0xffffffffffffffc5ULL, 0xffffffffffffffffULL, 1000000007, 998244353,
+		37, 41, 43, 47,
+	};
+
+	std::vector<uinteger_t> values = {
+		0,
+		1,
+		uinteger_t(0xffffffffffffffffULL),
+		uinteger_t(0xffffffffffffffffULL, 0xffffffffffffffffULL),
+		uinteger_t(0xfedcba9876543210ULL, 0, 0x0123456789abcdefULL),
+		(uinteger_t(1) << 1000) - 1,
+		uinteger_t(3).pow(500),
+	};
+	for (const auto& value : values) {
+		std::vector<uinteger_t::digit> remainders;
+		value.mod_small(divisors, remainders);
+		ASSERT_EQ(remainders.size(), divisors.size());
+		for (std::size_t i = 0; i < divisors.size(); ++i) {
+			EXPECT_EQ(remainders[i], value % divisors[i]) << value << " % " << divisors[i];
+		}
+
+		uinteger_t::digit remainder;
+		value.mod_small(&divisors[11], 1, &remainder);
+		EXPECT_EQ(remainder, value % divisors[11]);
+	}
+
+	uinteger_t::digit remainder;
+	const uinteger_t::digit zero = 0;
+	EXPECT_THROW(uinteger_t(1).mod_small(&zero, 1, &remainder), std::domain_error);
+}
@@ -0,0 +1,204 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "uinteger_t.hh"
+#include "random_uint.hh"
+
+TEST(Modular, montgomery) {
+	std::mt19937_64 engine(0x5eed);
+
+	for (const auto& digits : {1, 2, 3, 8, 32, 33, 64}) {
+		auto modulus = random_uint(engine, digits) | 1;
+		const montgomery_context ctx(modulus);
+		EXPECT_EQ(ctx.modulus(), modulus);
+		EXPECT_EQ(ctx.from_mont(ctx.one()), 1);
+
+		for (int i = 0; i < 10; ++i) {
+			auto a = random_uint(engine, digits) % modulus;
+			auto b = random_uint(engine, digits) % modulus;
+			auto ma = ctx.to_mont(a);
+			auto mb = ctx.to_mont(b);
+			EXPECT_EQ(ctx.from_mont(ma), a);
+			EXPECT_EQ(ctx.from_mont(ctx.mont_mul(ma, mb)), (a * b) % modulus);
+			EXPECT_EQ(ctx.from_mont(ctx.mont_sqr(ma)), (a * a) % modulus);
+			EXPECT_EQ(ctx.mont_mul(ma, ctx.one()), ma);
+		}
+
+		// Biggest values, and unreduced values when converting:
+		auto max = modulus - 1;
+		auto mmax = ctx.to_mont(max);
+		EXPECT_EQ(ctx.from_mont(ctx.mont_mul(mmax, mmax)), 1);
+		EXPECT_EQ(ctx.from_mont(ctx.mont_sqr(mmax)), 1);
+		EXPECT_EQ(ctx.from_mont(ctx.to_mont(modulus * 3 + 2)), 2);
+		EXPECT_EQ(ctx.to_mont(0), 0);
+	}
+
+	// Big enough to multiply before reducing:
+	auto modulus = random_uint(engine, 100);
+	const montgomery_context ctx(modulus);
+	auto a = random_uint(engine, 100) % modulus;
+	auto b = random_uint(engine, 99);
+	EXPECT_EQ(ctx.from_mont(ctx.mont_mul(ctx.to_mont(a), ctx.to_mont(b))), (a * b) % modulus);
+
+	EXPECT_THROW(montgomery_context(0), std::invalid_argument);
+	EXPECT_THROW(montgomery_context(0x10000), std::invalid_argument);
+}
+
+TEST(Modular, barrett) {
+	std::mt19937_64 engine(0x5eed);
+
+	for (const auto& digits : {1, 2, 3, 8, 16, 17, 40}) {
+		for (const auto& modulus : {random_uint(engine, digits), random_uint(engine, digits) << 1, uinteger_t(1) << (digits * 64 - 1), (uinteger_t(1) << (digits * 64)) - 1}) {
+			const barrett_context ctx(modulus);
+			EXPECT_EQ(ctx.modulus(), modulus);
+
+			for (int i = 0; i < 10; ++i) {
+				auto x = random_uint(engine, 2 * digits);
+				EXPECT_EQ(ctx.reduce(x), x % modulus);
+				auto a = random_uint(engine, digits) % modulus;
+				auto b = random_uint(engine, digits) % modulus;
+				EXPECT_EQ(ctx.mod_mul(a, b), (a * b) % modulus);
+				EXPECT_EQ(ctx.mod_sqr(a), (a * a) % modulus);
+			}
+
+			// Edges of the range, and out of range:
+			auto max = (uinteger_t(1) << (2 * digits * 64)) - 1;
+			EXPECT_EQ(ctx.reduce(max), max % modulus);
+			EXPECT_EQ(ctx.reduce(modulus - 1), modulus - 1);
+			EXPECT_EQ(ctx.reduce(modulus), 0);
+			EXPECT_EQ(ctx.reduce(modulus * (modulus - 1)), 0);
+			EXPECT_EQ(ctx.reduce(0), 0);
+			auto big = random_uint(engine, 3 * digits);
+			EXPECT_EQ(ctx.reduce(big), big % modulus);
+		}
+	}
+
+	EXPECT_THROW(barrett_context(0), std::domain_error);
+}
+
+// Right to left binary exponentiation, reducing with divmod
+static uinteger_t naive_powmod(uinteger_t base, uinteger_t exp, const uinteger_t& mod) {
+	uinteger_t result = uinteger_t(1) % mod;
+	base %= mod;
+	while (exp) {
+		if (exp & 1) {
+			result = (result * base) % mod;
+		}
+		base = (base * base) % mod;
+		exp >>= 1;
+	}
+	return result;
+}
+
+TEST(Modular, powmod) {
+	std::mt19937_64 engine(0x5eed);
+
+	for (const auto& digits : {1, 2, 5, 16, 17}) {
+		for (const auto& mod : {random_uint(engine, digits) | 1, random_uint(engine, digits) << 3}) {
+			for (const auto& exp_digits : {0, 1, 3, 12}) {
+				auto base = random_uint(engine, digits + 1);
+				auto exp = exp_digits ? random_uint(engine, exp_digits) : uinteger_t(0);
+				auto expected = naive_powmod(base, exp, mod);
+				EXPECT_EQ(base.powmod(exp, mod), expected);
+				if (mod & 1) {
+					EXPECT_EQ(base.powmod_sec(exp, mod), expected);
+				}
+			}
+			EXPECT_EQ(uinteger_t(0).powmod(0, mod), 1);
+			EXPECT_EQ(uinteger_t(0).powmod(5, mod), 0);
+			EXPECT_EQ((mod - 1).powmod(2, mod), 1);
+		}
+	}
+
+	// Fermat's little theorem, on Mersenne primes:
+	for (const auto& p : {127, 521, 1279}) {
+		auto prime = (uinteger_t(1) << p) - 1;
+		auto a = random_uint(engine, p / 64) % prime;
+		EXPECT_EQ(a.powmod(prime - 1, prime), 1);
+		EXPECT_EQ(a.powmod_sec(prime - 1, prime), 1);
+		EXPECT_EQ(a.powmod(prime, prime), a);
+	}
+
+	// Powers of two moduli:
+	EXPECT_EQ(uinteger_t(3).powmod(uinteger_t(1) << 100, uinteger_t(1) << 64), naive_powmod(3, uinteger_t(1) << 100, uinteger_t(1) << 64));
+	EXPECT_EQ(uinteger_t(12345).powmod(678, 1), 0);
+	EXPECT_EQ(uinteger_t(12345).powmod_sec(678, 1), 0);
+
+	EXPECT_THROW(uinteger_t(2).powmod(3, 0), std::domain_error);
+	EXPECT_THROW(uinteger_t(2).powmod_sec(3, 4), std::invalid_argument);
+}
+
+TEST(Modular, contexts_pow) {
+	std::mt19937_64 engine(0x5eed);
+
+	auto mod = random_uint(engine, 32);
+	const montgomery_context montgomery(mod);
+	const barrett_context barrett(mod);
+	for (int i = 0; i < 4; ++i) {
+		auto base = random_uint(engine, 40);
+		auto exp = random_uint(engine, 8);
+		auto expected = naive_powmod(base, exp, mod);
+		EXPECT_EQ(montgomery.pow(base, exp), expected);
+		EXPECT_EQ(montgomery.pow_sec(base, exp), expected);
+		EXPECT_EQ(barrett.pow(base, exp), expected);
+	}
+}
+
+TEST(Modular, invmod) {
+	EXPECT_EQ(uinteger_t(3).invmod(7), 5);
+	EXPECT_EQ(uinteger_t(10).invmod(7), 5);
+	EXPECT_EQ(uinteger_t(1).invmod(2), 1);
+	EXPECT_EQ(uinteger_t(5).invmod(1), 0);
+	EXPECT_THROW(uinteger_t(0).invmod(7), std::domain_error);
+	EXPECT_THROW(uinteger_t(6).invmod(9), std::domain_error);
+	EXPECT_THROW(uinteger_t(3).invmod(0), std::domain_error);
+
+	std::mt19937_64 engine(0x1a7);
+	for (const auto& digits : {1, 2, 10, 60, 300}) {
+		for (const auto& mod : {random_uint(engine, digits) | 1, random_uint(engine, digits) << 3}) {
+			auto value = random_uint(engine, digits + 2) | 1;
+			if (value.gcd(mod) == 1) {
+				auto inverse = value.invmod(mod);
+				EXPECT_LT(inverse, mod);
+				EXPECT_EQ(value * inverse % mod, 1);
+			} else {
+				EXPECT_THROW(value.invmod(mod), std::domain_error);
+			}
+		}
+	}
+
+	// Large enough for the half GCD:
+	auto prime = (uinteger_t(1) << 216091) - 1;
+	auto value = random_uint(engine, 3000);
+	EXPECT_EQ(value * value.invmod(prime) % prime, 1);
+}
+
+TEST(Modular, batch_invmod) {
+	std::mt19937_64 engine(0xba7);
+	for (const auto& mod : {(uinteger_t(1) << 521) - 1, random_uint(engine, 20) << 1}) {
+		std::vector<uinteger_t> values;
+		for (int i = 0; i < 16; ++i) {
+			auto value = random_uint(engine, 1 + i * 3) | 1;
+			while (value.gcd(mod) != 1) {
+				value += 2;
+			}
+			values.push_back(value);
+		}
+		auto inverses = values;
+		uinteger_t::batch_invmod(inverses, mod);
+		for (std::size_t i = 0; i < values.size(); ++i) {
+			EXPECT_EQ(inverses[i], values[i].invmod(mod));
+		}
+	}
+
+	std::vector<uinteger_t> single = {3};
+	uinteger_t::batch_invmod(single, 7);
+	EXPECT_EQ(single[0], 5);
+	std::vector<uinteger_t> empty;
+	uinteger_t::batch_invmod(empty, 7);
+	EXPECT_TRUE(empty.empty());
+
+	std::vector<uinteger_t> singular = {3, 4, 5};
+	EXPECT_THROW(uinteger_t::batch_invmod(singular, 6), std::domain_error);
+}
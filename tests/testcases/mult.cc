@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "uinteger_t.hh"
+#include "random_uint.hh"
 
 TEST(Arithmetic, multiply) {
 	uinteger_t val(0xfedbca9876543210ULL);
@@ -49,3 +53,155 @@ TEST(External, inplace) {
 	}
 	EXPECT_EQ(val, 0x3ade68b1);
 }
+
+// Schoolbook multiplication, one digit of rhs at a time
+static uinteger_t schoolbook(const uinteger_t& lhs, const uinteger_t& rhs) {
+	uinteger_t result;
+	for (std::size_t i = rhs.size(); i--;) {
+		result <<= 64;
+		result += lhs * uinteger_t(rhs.value(i));
+	}
+	return result;
+}
+
+TEST(Arithmetic, multiply_large) {
+	std::mt19937_64 engine(0);
+
+	// balanced sizes (Karatsuba, Toom-3, Toom-4 and NTT)
+	for (const auto& digits : {20, 200, 700, 1000, 1500, 3000}) {
+		auto lhs = random_uint(engine, digits);
+		auto rhs = random_uint(engine, digits);
+		EXPECT_EQ(lhs * rhs, schoolbook(lhs, rhs));
+	}
+
+	// unbalanced sizes (Toom-32 and slices)
+	for (const auto& sizes : {std::make_pair(250, 400), std::make_pair(200, 700), std::make_pair(700, 1000), std::make_pair(700, 2500), std::make_pair(1200, 2500)}) {
+		auto lhs = random_uint(engine, sizes.first);
+		auto rhs = random_uint(engine, sizes.second);
+		EXPECT_EQ(lhs * rhs, schoolbook(lhs, rhs));
+		EXPECT_EQ(rhs * lhs, schoolbook(lhs, rhs));
+	}
+
+	// pieces with zeros
+	for (const auto& digits : {250, 1000}) {
+		auto lhs = random_uint(engine, digits, 0, digits / 2);
+		auto rhs = random_uint(engine, digits, digits / 4, 3 * digits / 4);
+		EXPECT_EQ(lhs * rhs, schoolbook(lhs, rhs));
+	}
+	// largest digits (biggest convolution values for NTT)
+	const auto ones = (uinteger_t(1) << 2000 * 64) - 1;
+	EXPECT_EQ(ones * ones, (uinteger_t(1) << 4000 * 64) - (uinteger_t(1) << (2000 * 64 + 1)) + 1);
+
+	auto lhs = random_uint(engine, 250);
+	auto rhs = random_uint(engine, 2000, 300, 1900);
+	EXPECT_EQ(lhs * rhs, schoolbook(lhs, rhs));
+	EXPECT_EQ((lhs << 16000) * (rhs << 32000), schoolbook(lhs, rhs) << 48000);
+}
+
+TEST(Arithmetic, scratch_arena) {
+	std::mt19937_64 engine(2);
+	auto& arena = uinteger_t::scratch_arena::local();
+	const auto capacity = arena.capacity();
+
+	// default, too small (falling back to the allocator) and disabled arenas
+	for (const auto& size : {capacity, std::size_t(3000), std::size_t(0)}) {
+		arena.resize(size);
+		EXPECT_EQ(arena.capacity(), size);
+		EXPECT_EQ(arena.peak(), 0u);
+		for (const auto& digits : {200, 1000, 3000}) {
+			auto lhs = random_uint(engine, digits);
+			auto rhs = random_uint(engine, digits);
+			auto product = lhs * rhs;
+			EXPECT_EQ(product, schoolbook(lhs, rhs));
+			EXPECT_EQ(lhs.sqr(), schoolbook(lhs, lhs));
+			EXPECT_EQ((product + rhs - 1) / rhs, lhs);
+			EXPECT_EQ((product + rhs - 1) % rhs, rhs - 1);
+			EXPECT_EQ(arena.used(), 0u);
+		}
+		// (Toom and Burnikel-Ziegler temporaries took their digits from it)
+		if (size) {
+			EXPECT_GT(arena.peak(), 0u);
+			EXPECT_LE(arena.peak(), size);
+		} else {
+			EXPECT_EQ(arena.peak(), 0u);
+		}
+	}
+
+	arena.resize(capacity);
+	EXPECT_EQ(arena.capacity(), capacity);
+
+	// Moving out of scratch temporaries copies the digits out of the arena
+	std::vector<uinteger_t::container> results;
+	{
+		uinteger_t::container a(uinteger_t::allocator_type(), true);
+		uinteger_t::container b(uinteger_t::allocator_type(), true);
+		a.resize(1000, 7);
+		b.resize(1000, 9);
+		EXPECT_EQ(arena.used(), 2 * (1000u + 1));  // (and a digit for each size)
+		results.push_back(std::move(a));
+		results.emplace_back();
+		results.back() = std::move(b);
+	}
+	EXPECT_EQ(arena.used(), 0u);
+	for (const auto& result : results) {
+		EXPECT_FALSE(result.scratch());
+		EXPECT_FALSE(arena.contains(result.data()));
+		EXPECT_EQ(result.size(), 1000u);
+	}
+	EXPECT_EQ(std::count(results[0].begin(), results[0].end(), 7), 1000);
+	EXPECT_EQ(std::count(results[1].begin(), results[1].end(), 9), 1000);
+}
+
+TEST(Arithmetic, square) {
+	std::mt19937_64 engine(1);
+
+	const uinteger_t zero = 0;
+	const uinteger_t one = 1;
+	EXPECT_EQ(zero.sqr(), zero);
+	EXPECT_EQ(one.sqr(), one);
+	EXPECT_EQ(uinteger_t(0xfedbca9876543210ULL).sqr(), uinteger_t(0xfdb8e2bacbfe7cefULL, 0x010e6cd7a44a4100ULL));
+
+	// all the squaring algorithms, up to NTT
+	for (const auto& digits : {2, 3, 20, 50, 200, 700, 1500}) {
+		auto val = random_uint(engine, digits);
+		auto expected = schoolbook(val, val);
+		EXPECT_EQ(val.sqr(), expected);
+		EXPECT_EQ(val * val, expected);
+		EXPECT_EQ(val * uinteger_t(val), expected);
+		val *= val;
+		EXPECT_EQ(val, expected);
+	}
+
+	// pieces with zeros and largest digits
+	for (const auto& digits : {250, 1000}) {
+		auto val = random_uint(engine, digits, digits / 4, 3 * digits / 4);
+		EXPECT_EQ(val.sqr(), schoolbook(val, val));
+		const auto ones = (uinteger_t(1) << digits * 64) - 1;
+		EXPECT_EQ(ones.sqr(), (uinteger_t(1) << digits * 128) - (uinteger_t(1) << (digits * 64 + 1)) + 1);
+	}
+}
+
+TEST(Arithmetic, pow) {
+	EXPECT_EQ(uinteger_t(0).pow(0), 1);
+	EXPECT_EQ(uinteger_t(0).pow(5), 0);
+	EXPECT_EQ(uinteger_t(1).pow(1000), 1);
+	EXPECT_EQ(uinteger_t(7).pow(1), 7);
+	EXPECT_EQ(uinteger_t(3).pow(40), 12157665459056928801ULL);
+	EXPECT_EQ(uinteger_t(10).pow(19), 10000000000000000000ULL);
+
+	// Powers of two are shifts:
+	EXPECT_EQ(uinteger_t(2).pow(1000), uinteger_t(1) << 1000);
+	EXPECT_EQ((uinteger_t(1) << 100).pow(30), uinteger_t(1) << 3000);
+
+	// Against repeated multiplication:
+	std::mt19937_64 engine(0x5eed);
+	for (const auto& base : {uinteger_t(10), uinteger_t(12), uinteger_t(0xfffffffffffffffULL), random_uint(engine, 3), random_uint(engine, 40) << 70}) {
+		for (const auto& exp : {2, 3, 17, 64, 255}) {
+			uinteger_t expected = 1;
+			for (int i = 0; i < exp; ++i) {
+				expected *= base;
+			}
+			EXPECT_EQ(base.pow(exp), expected);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "uinteger_t.hh"
+#include "random_uint.hh"
+
+// Sieve of Eratosthenes
+static std::vector<bool> sieve(std::size_t limit) {
+	std::vector<bool> prime(limit, true);
+	prime[0] = prime[1] = false;
+	for (std::size_t i = 2; i * i < limit; ++i) {
+		if (prime[i]) {
+			for (auto j = i * i; j < limit; j += i) {
+				prime[j] = false;
+			}
+		}
+	}
+	return prime;
+}
+
+TEST(Primes, is_probable_prime) {
+	// Against a sieve (small primes, trial division and Baillie-PSW):
+	auto prime = sieve(1 << 21);
+	for (std::size_t n = 0; n < prime.size(); n += n < 70000 ? 1 : 7) {
+		EXPECT_EQ(uinteger_t(n).is_probable_prime(), prime[n]) << n;
+	}
+
+	// Mersenne primes, and their neighbours:
+	for (const auto& p : {61, 89, 107, 127, 521, 607, 1279}) {
+		auto mersenne = (uinteger_t(1) << p) - 1;
+		EXPECT_TRUE(mersenne.is_probable_prime()) << p;
+		EXPECT_TRUE(mersenne.is_probable_prime(5)) << p;
+		EXPECT_FALSE((mersenne + 2).is_probable_prime() && (mersenne - 2).is_probable_prime()) << p;
+	}
+	EXPECT_FALSE(((uinteger_t(1) << 67) - 1).is_probable_prime());
+	EXPECT_FALSE(((uinteger_t(1) << 128) + 1).is_probable_prime());
+
+	// Carmichael numbers and strong pseudoprimes (to many bases):
+	for (const auto& n : {561ULL, 41041ULL, 825265ULL, 321197185ULL, 3215031751ULL, 3825123056546413051ULL}) {
+		EXPECT_FALSE(uinteger_t(n).is_probable_prime()) << n;
+	}
+	EXPECT_FALSE(uinteger_t("318665857834031151167461").is_probable_prime());
+
+	// Products of two primes and squares of primes:
+	std::mt19937_64 engine(0x9e1);
+	auto p = random_uint(engine, 2).next_prime();
+	auto q = random_uint(engine, 3).next_prime();
+	EXPECT_TRUE(p.is_probable_prime());
+	EXPECT_TRUE(q.is_probable_prime());
+	EXPECT_FALSE((p * q).is_probable_prime());
+	EXPECT_FALSE((p * p).is_probable_prime());
+	EXPECT_FALSE(uinteger_t(1000003ULL * 1000003ULL).is_probable_prime());
+}
+
+TEST(Primes, next_prime) {
+	auto prime = sieve(200000);
+	for (std::size_t n = 0; n < 100000; n += 37) {
+		auto next = n + 1;
+		while (!prime[next]) {
+			++next;
+		}
+		EXPECT_EQ(uinteger_t(n).next_prime(), next) << n;
+	}
+	EXPECT_EQ(uinteger_t(0).next_prime(), 2);
+	EXPECT_EQ(uinteger_t(2).next_prime(), 3);
+	EXPECT_EQ(uinteger_t(65521).next_prime(), 65537);
+	EXPECT_EQ(uinteger_t(1, 0).next_prime(), uinteger_t(1, 13));
+	EXPECT_EQ((uinteger_t(1) << 128).next_prime(), (uinteger_t(1) << 128) + 51);
+	EXPECT_EQ(((uinteger_t(1) << 127) - 2).next_prime(), (uinteger_t(1) << 127) - 1);
+
+	// No primes are skipped:
+	std::mt19937_64 engine(0x9e2);
+	for (const auto& digits : {1, 4, 8}) {
+		auto start = random_uint(engine, digits);
+		auto next = start.next_prime();
+		EXPECT_TRUE(next.is_probable_prime());
+		for (auto n = start + 1; n < next; ++n) {
+			EXPECT_FALSE(n.is_probable_prime()) << n;
+		}
+	}
+}
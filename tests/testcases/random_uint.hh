@@ -0,0 +1,22 @@
+#ifndef __random_uint__
+#define __random_uint__
+
+#include <random>
+#include <string>
+
+#include "uinteger_t.hh"
+
+// Builds numbers from pseudo-random bytes, optionally zeroing a range
+// of digits, so the splits used by the multiplication algorithms get
+// empty pieces too.
+inline uinteger_t random_uint(std::mt19937_64& engine, std::size_t digits, std::size_t zero_from = 0, std::size_t zero_to = 0) {
+	std::string bytes;
+	for (std::size_t i = 0; i < digits * 8; ++i) {
+		auto digit = digits - 1 - i / 8;
+		bytes.push_back(digit >= zero_from && digit < zero_to ? 0 : static_cast<char>(engine()));
+	}
+	bytes[0] |= 1;
+	return uinteger_t(bytes, 256);
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "uinteger_t.hh"
+#include "random_uint.hh"
+
+// Checks root is floor(num^(1/k))
+static void check_root(const uinteger_t& num, const uinteger_t& root, std::size_t k) {
+	EXPECT_LE(root.pow(k), num);
+	EXPECT_GT((root + 1).pow(k), num);
+}
+
+TEST(Roots, isqrt) {
+	for (const auto& n : {0, 1, 2, 3, 4, 5, 8, 9, 10, 15, 16, 17, 99, 100, 101}) {
+		auto root = uinteger_t(n).isqrt();
+		check_root(n, root, 2);
+	}
+	EXPECT_EQ(uinteger_t(0xffffffffffffffffULL).isqrt(), 0xffffffffULL);
+	EXPECT_EQ(uinteger_t(1, 0).isqrt(), 0x100000000ULL);
+	EXPECT_EQ(((uinteger_t(1) << 128) - 1).isqrt(), 0xffffffffffffffffULL);
+
+	std::mt19937_64 engine(0x5a7);
+	for (const auto& digits : {1, 2, 3, 10, 33, 200, 1000}) {
+		auto num = random_uint(engine, digits);
+		auto root = num.isqrt();
+		check_root(num, root, 2);
+		EXPECT_EQ(root.sqr().isqrt(), root);
+		EXPECT_EQ((root.sqr() - 1).isqrt(), root - 1);
+
+		auto res = num.isqrt_rem();
+		EXPECT_EQ(res.first, root);
+		EXPECT_EQ(res.second, num - root.sqr());
+	}
+}
+
+TEST(Roots, iroot) {
+	EXPECT_EQ(uinteger_t(0).iroot(3), 0);
+	EXPECT_EQ(uinteger_t(1).iroot(3), 1);
+	EXPECT_EQ(uinteger_t(7).iroot(3), 1);
+	EXPECT_EQ(uinteger_t(8).iroot(3), 2);
+	EXPECT_EQ(uinteger_t(26).iroot(3), 2);
+	EXPECT_EQ(uinteger_t(27).iroot(3), 3);
+	EXPECT_EQ(uinteger_t(12345).iroot(1), 12345);
+	EXPECT_EQ(uinteger_t(1000000).iroot(2), 1000);
+	EXPECT_EQ(uinteger_t(1000000).iroot(100), 1);
+	EXPECT_THROW(uinteger_t(8).iroot(0), std::domain_error);
+
+	std::mt19937_64 engine(0x1007);
+	for (const auto& digits : {1, 2, 5, 40, 300}) {
+		for (const auto& k : {3, 5, 7, 64, 1000}) {
+			auto num = random_uint(engine, digits);
+			auto root = num.iroot(k);
+			check_root(num, root, k);
+			if (root > 1) {
+				auto power = root.pow(k);
+				EXPECT_EQ(power.iroot(k), root);
+				EXPECT_EQ((power - 1).iroot(k), root - 1);
+			}
+		}
+	}
+}
+
+TEST(Roots, is_perfect_square) {
+	EXPECT_TRUE(uinteger_t(0).is_perfect_square());
+	EXPECT_TRUE(uinteger_t(1).is_perfect_square());
+	EXPECT_FALSE(uinteger_t(2).is_perfect_square());
+	EXPECT_TRUE(uinteger_t(144).is_perfect_square());
+	EXPECT_FALSE(uinteger_t(145).is_perfect_square());
+
+	for (int n = 0; n < 2000; ++n) {
+		auto root = uinteger_t(n).isqrt();
+		EXPECT_EQ(uinteger_t(n).is_perfect_square(), root * root == n);
+	}
+
+	std::mt19937_64 engine(0x5a1);
+	for (const auto& digits : {1, 2, 7, 100}) {
+		auto root = random_uint(engine, digits);
+		auto square = root.sqr();
+		EXPECT_TRUE(square.is_perfect_square());
+		EXPECT_FALSE((square + 1).is_perfect_square());
+		EXPECT_FALSE((square - 1).is_perfect_square());
+		EXPECT_FALSE((square + (root << 1)).is_perfect_square());
+	}
+}
@@ -49,6 +49,13 @@ to header-only and extended to arbitrary bit length.
 #include <stdexcept>
 #include <functional>
 #include <type_traits>
+#include <limits>
+#include <tuple>
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <iterator>
+#include <system_error>
 
 // Compatibility inlines
 #ifndef __has_builtin         // Optional of course
@@ -77,6 +84,15 @@ to header-only and extended to arbitrary bit length.
 #if (defined(__clang__) && __has_builtin(__builtin_clz)) || (defined(__GNUC__ ) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 3)))
 #  define HAVE____BUILTIN_CLZ
 #endif
+#if (defined(__clang__) && __has_builtin(__builtin_ctzll)) || (defined(__GNUC__ ) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)))
+#  define HAVE____BUILTIN_CTZLL
+#endif
+#if (defined(__clang__) && __has_builtin(__builtin_ctzl)) || (defined(__GNUC__ ) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)))
+#  define HAVE____BUILTIN_CTZL
+#endif
+#if (defined(__clang__) && __has_builtin(__builtin_ctz)) || (defined(__GNUC__ ) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4)))
+#  define HAVE____BUILTIN_CTZ
+#endif
 #if (defined(__clang__) && __has_builtin(__builtin_addcll))
 #  define HAVE____BUILTIN_ADDCLL
 #endif
@@ -100,6 +116,16 @@ to header-only and extended to arbitrary bit length.
 #define HAVE____INT128_T
 #endif
 
+#if (defined(__clang__) && __has_builtin(__builtin_is_constant_evaluated)) || (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#  define HAVE____BUILTIN_IS_CONSTANT_EVALUATED
+#endif
+
+// SSSE3 and AVX2 code is compiled with target attributes and selected at runtime
+#if !defined UINT_T_NO_SIMD && (defined(__x86_64__) || defined(__i386__)) && ((defined(__clang__) && __has_builtin(__builtin_cpu_supports)) || (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 5))
+#  define HAVE____BUILTIN_CPU_SUPPORTS
+#  include <immintrin.h>
+#endif
+
 
 #ifndef DIGIT_T
 #define DIGIT_T        std::uint64_t
@@ -109,16 +135,114 @@ to header-only and extended to arbitrary bit length.
 #define HALF_DIGIT_T   std::uint32_t
 #endif
 
-class uinteger_t;
+// Multiplication cutoffs (in bits of the smallest operand)
+#ifndef KARATSUBA_CUTOFF
+#define KARATSUBA_CUTOFF  1024
+#endif
+
+#ifndef TOOM3_CUTOFF
+#define TOOM3_CUTOFF      12288
+#endif
+
+#ifndef TOOM4_CUTOFF
+#define TOOM4_CUTOFF      40960
+#endif
+
+#ifndef NTT_CUTOFF
+#define NTT_CUTOFF        65536
+#endif
+
+// Division cutoffs (in bits of the divisor)
+#ifndef BURNIKEL_ZIEGLER_CUTOFF
+#define BURNIKEL_ZIEGLER_CUTOFF  8192
+#endif
+
+#ifndef NEWTON_CUTOFF
+#define NEWTON_CUTOFF            1048576
+#endif
+
+#ifndef NEWTON_RECIPROCAL_CUTOFF
+#define NEWTON_RECIPROCAL_CUTOFF 16384
+#endif
+
+// GCD cutoffs (in bits)
+#ifndef HALF_GCD_CUTOFF
+#define HALF_GCD_CUTOFF  6144
+#endif
+
+#ifndef GCD_HALF_GCD_CUTOFF
+#define GCD_HALF_GCD_CUTOFF  131072
+#endif
+
+// Conversion cutoffs (in bits)
+#ifndef STR_DC_CUTOFF
+#define STR_DC_CUTOFF       4096
+#endif
+
+#ifndef STRTOUINT_DC_CUTOFF
+#define STRTOUINT_DC_CUTOFF 4096
+#endif
+
+// Size of the cache of powers of the bases used by the conversions (in bits)
+#ifndef RADIX_POWERS_CACHE_SIZE
+#define RADIX_POWERS_CACHE_SIZE 33554432
+#endif
+
+// Squaring cutoffs (in bits)
+#ifndef KARATSUBA_SQR_CUTOFF
+#define KARATSUBA_SQR_CUTOFF  2048
+#endif
+
+#ifndef TOOM3_SQR_CUTOFF
+#define TOOM3_SQR_CUTOFF      TOOM3_CUTOFF
+#endif
+
+#ifndef TOOM4_SQR_CUTOFF
+#define TOOM4_SQR_CUTOFF      TOOM4_CUTOFF
+#endif
+
+#ifndef NTT_SQR_CUTOFF
+#define NTT_SQR_CUTOFF        NTT_CUTOFF
+#endif
+
+// Size of the numbers kept without allocating (in bits)
+#ifndef SMALL_BUFFER_SIZE
+#define SMALL_BUFFER_SIZE 256
+#endif
+
+// Size of the per thread scratch arena for the temporaries of multiplications
+// and divisions (in bits)
+#ifndef SCRATCH_ARENA_SIZE
+#define SCRATCH_ARENA_SIZE 8388608
+#endif
+
+template <typename Alloc = std::allocator<DIGIT_T>> class basic_uinteger_t;
+template <typename Alloc> class basic_montgomery_context;
+template <typename Alloc> class basic_barrett_context;
+template <std::size_t Bits> class uint_t;
+
+using uinteger_t = basic_uinteger_t<>;
+using montgomery_context = basic_montgomery_context<std::allocator<DIGIT_T>>;
+using barrett_context = basic_barrett_context<std::allocator<DIGIT_T>>;
 
 namespace std {  // This is probably not a good idea
 	// Give uinteger_t type traits
-	template <> struct is_arithmetic <uinteger_t> : std::true_type {};
-	template <> struct is_integral   <uinteger_t> : std::true_type {};
-	template <> struct is_unsigned   <uinteger_t> : std::true_type {};
+	template <typename Alloc> struct is_arithmetic <basic_uinteger_t<Alloc>> : std::true_type {};
+	template <typename Alloc> struct is_integral   <basic_uinteger_t<Alloc>> : std::true_type {};
+	template <typename Alloc> struct is_unsigned   <basic_uinteger_t<Alloc>> : std::true_type {};
 }
 
-class uinteger_t {
+// Digits are allocated with Alloc (rebound to digit, if needed); copies get
+// the allocator of the number copied, and the results and temporaries of the
+// operations that of their (left hand side) operand. Alloc must be default
+// constructible, for the temporaries that don't come from an operand.
+template <typename Alloc>
+class basic_uinteger_t {
+	// Within the class, these are the ones of the same allocator
+	using uinteger_t = basic_uinteger_t;
+	using montgomery_context = basic_montgomery_context<Alloc>;
+	using barrett_context = basic_barrett_context<Alloc>;
+
 public:
 	using digit = DIGIT_T;
 	using half_digit = HALF_DIGIT_T;
@@ -128,29 +252,340 @@ public:
 	static constexpr std::size_t half_digit_octets = sizeof(half_digit);   // number of octets per half_digit
 	static constexpr std::size_t half_digit_bits = half_digit_octets * 8;  // number of bits per half_digit
 
-	using container = std::vector<digit>;
+	// Number of digits kept inside the numbers themselves
+	static constexpr std::size_t small_buffer_digits = SMALL_BUFFER_SIZE / digit_bits ? SMALL_BUFFER_SIZE / digit_bits : 1;
+
+	// Bump allocator for the digits of temporaries, one per thread (local()).
+	// Each block is followed by a digit with its size, and a flag telling
+	// whether it was released; blocks can be released in any order, but their
+	// space is only taken back once the ones after them are released too, so
+	// it's reused in stack order. Temporaries that don't fit use the allocator.
+	// Its digits never escape the functions using them: only the scratch
+	// temporaries declared there hold them, and constructing or assigning
+	// any other number from one (moving too) copies the digits out.
+	class scratch_arena {
+	public:
+		explicit scratch_arena(std::size_t sz = SCRATCH_ARENA_SIZE / digit_bits) :
+			_data(sz ? new digit[sz] : nullptr),
+			_capacity(sz),
+			_top(0),
+			_peak(0) { }
+
+		scratch_arena(const scratch_arena&) = delete;
+		scratch_arena& operator=(const scratch_arena&) = delete;
+
+		// The arena of the calling thread
+		static scratch_arena& local() {
+			static thread_local scratch_arena arena;
+			return arena;
+		}
+
+		// Sets the size (in digits, zero disables it), only while it's unused
+		void resize(std::size_t sz) {
+			if (_top) {
+				throw std::logic_error("Error: scratch arena in use");
+			}
+			_data.reset(sz ? new digit[sz] : nullptr);
+			_capacity = sz;
+			_peak = 0;
+		}
+
+		std::size_t capacity() const noexcept { return _capacity; }
+		std::size_t used() const noexcept { return _top; }
+
+		// Most digits used at once since the last resize(), for sizing it
+		std::size_t peak() const noexcept { return _peak; }
+
+		bool contains(const digit* ptr) const noexcept {
+			return !std::less<const digit*>()(ptr, _data.get()) && std::less<const digit*>()(ptr, _data.get() + _capacity);
+		}
+
+		// Block of sz digits, or nullptr if it doesn't fit
+		digit* allocate(std::size_t sz) noexcept {
+			if (sz >= _capacity - _top) {
+				return nullptr;
+			}
+			auto ptr = _data.get() + _top;
+			_top += sz + 1;
+			_data[_top - 1] = sz << 1;
+			_peak = std::max(_peak, _top);
+			return ptr;
+		}
+
+		void release(digit* ptr, std::size_t sz) noexcept {
+			auto end = static_cast<std::size_t>(ptr - _data.get()) + sz;
+			_data[end] |= 1;
+			// Take back the released blocks at the top:
+			while (_top && (_data[_top - 1] & 1)) {
+				_top -= (_data[_top - 1] >> 1) + 1;
+			}
+		}
+
+	private:
+		std::unique_ptr<digit[]> _data;
+		std::size_t _capacity;
+		std::size_t _top;
+		std::size_t _peak;
+	};
+
+	using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<digit>;
+
+	// Vector of digits which keeps the first small_buffer_digits of them in
+	// a buffer of its own and only goes to the allocator for bigger numbers
+	// (it has just the parts of the std::vector interface used by uinteger_t).
+	// Scratch ones, for temporaries, take bigger buffers from the scratch
+	// arena; only those can have digits in it, and moving them to the others
+	// (which includes move constructing, as that never makes a scratch one)
+	// copies the digits, so moves can throw.
+	class small_vector : private allocator_type {
+		using traits = std::allocator_traits<allocator_type>;
+
+	public:
+		using value_type = digit;
+		using reference = digit&;
+		using const_reference = const digit&;
+		using iterator = digit*;
+		using const_iterator = const digit*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		explicit small_vector(const allocator_type& alloc = allocator_type(), bool scratch = false) noexcept :
+			allocator_type(alloc),
+			_data(_small),
+			_size(0),
+			_capacity(small_buffer_digits),
+			_scratch(scratch) { }
+
+		template <typename It>
+		small_vector(It first, It last, const allocator_type& alloc = allocator_type()) :
+			small_vector(alloc) {
+			assign(first, last);
+		}
+
+		small_vector(const small_vector& o) :
+			small_vector(o.begin(), o.end(), traits::select_on_container_copy_construction(o.get_allocator())) { }
+
+		small_vector(small_vector&& o) :
+			small_vector(o.get_allocator()) {
+			if (o.borrowed()) {
+				assign(o.begin(), o.end());
+			} else {
+				steal(o);
+			}
+		}
+
+		~small_vector() {
+			release();
+		}
+
+		small_vector& operator=(const small_vector& o) {
+			if (this != &o) {
+				if (traits::propagate_on_container_copy_assignment::value && get_allocator() != o.get_allocator()) {
+					reset();
+				}
+				if (traits::propagate_on_container_copy_assignment::value) {
+					allocator() = o.get_allocator();
+				}
+				assign(o.begin(), o.end());
+			}
+			return *this;
+		}
+
+		small_vector& operator=(small_vector&& o) {
+			if (this != &o) {
+				if (!_scratch && o.borrowed()) {
+					assign(o.begin(), o.end());
+				} else if (traits::propagate_on_container_move_assignment::value || get_allocator() == o.get_allocator()) {
+					reset();
+					if (traits::propagate_on_container_move_assignment::value) {
+						allocator() = std::move(o.allocator());
+					}
+					steal(o);
+				} else {
+					// Digits allocated by the other allocator can't be taken
+					assign(o.begin(), o.end());
+				}
+			}
+			return *this;
+		}
+
+		allocator_type get_allocator() const noexcept {
+			return *this;
+		}
+
+		bool scratch() const noexcept {
+			return _scratch;
+		}
+
+		// Reuses the storage already there (first and last can be in it)
+		template <typename It>
+		void assign(It first, It last) {
+			auto sz = static_cast<std::size_t>(std::distance(first, last));
+			if (sz > _capacity) {
+				auto data = allocate(sz);
+				std::copy(first, last, data);
+				release();
+				_data = data;
+				_capacity = sz;
+			} else {
+				std::copy(first, last, _data);
+			}
+			_size = sz;
+		}
+
+		void reserve(std::size_t sz) {
+			if (sz > _capacity) {
+				auto data = allocate(sz);
+				std::copy(_data, _data + _size, data);
+				release();
+				_data = data;
+				_capacity = sz;
+			}
+		}
+
+		void resize(std::size_t sz, const digit& c = 0) {
+			if (sz > _capacity) {
+				reserve(std::max(sz, _size * 2));
+			}
+			if (sz > _size) {
+				std::fill(_data + _size, _data + sz, c);
+			}
+			_size = sz;
+		}
+
+		iterator insert(const_iterator pos, std::size_t sz, const digit& c) {
+			auto idx = static_cast<std::size_t>(pos - _data);
+			if (_size + sz > _capacity) {
+				reserve(std::max(_size + sz, _size * 2));
+			}
+			std::copy_backward(_data + idx, _data + _size, _data + _size + sz);
+			std::fill_n(_data + idx, sz, c);
+			_size += sz;
+			return _data + idx;
+		}
+
+		void clear() noexcept {
+			_size = 0;
+		}
+
+		std::size_t size() const noexcept { return _size; }
+		std::size_t capacity() const noexcept { return _capacity; }
+		digit* data() noexcept { return _data; }
+		const digit* data() const noexcept { return _data; }
+
+		iterator begin() noexcept { return _data; }
+		const_iterator begin() const noexcept { return _data; }
+		const_iterator cbegin() const noexcept { return _data; }
+		iterator end() noexcept { return _data + _size; }
+		const_iterator end() const noexcept { return _data + _size; }
+		const_iterator cend() const noexcept { return _data + _size; }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+	private:
+		digit* _data;  // either _small, allocated, or in the scratch arena
+		std::size_t _size;
+		std::size_t _capacity;
+		bool _scratch;
+		digit _small[small_buffer_digits];
+
+		allocator_type& allocator() noexcept {
+			return *this;
+		}
+
+		digit* allocate(std::size_t sz) {
+			if (_scratch) {
+				if (auto data = scratch_arena::local().allocate(sz)) {
+					return data;
+				}
+			}
+			return traits::allocate(allocator(), sz);
+		}
+
+		// Whether the digits are in the scratch arena
+		bool borrowed() const noexcept {
+			return _scratch && _data != _small && scratch_arena::local().contains(_data);
+		}
+
+		void release() noexcept {
+			if (_data != _small) {
+				if (borrowed()) {
+					scratch_arena::local().release(_data, _capacity);
+				} else {
+					traits::deallocate(allocator(), _data, _capacity);
+				}
+			}
+		}
+
+		// Frees the digits, going back to the (empty) small buffer
+		void reset() noexcept {
+			release();
+			_data = _small;
+			_size = 0;
+			_capacity = small_buffer_digits;
+		}
+
+		// Takes the digits of o, leaving it empty (o is empty, in its small buffer)
+		void steal(small_vector& o) noexcept {
+			if (o._data == o._small) {
+				std::copy(o._data, o._data + o._size, _data);
+			} else {
+				_data = o._data;
+				_capacity = o._capacity;
+				o._data = o._small;
+				o._capacity = small_buffer_digits;
+			}
+			_size = o._size;
+			o._size = 0;
+		}
+	};
+
+	using container = small_vector;
 
 	template <typename T>
 	struct is_result {
 		static const bool value = false;
 	};
 
-	template <typename T, typename Alloc>
-	struct is_result<std::vector<T, Alloc>> {
+	template <typename T, typename Allocator>
+	struct is_result<std::vector<T, Allocator>> {
 		static const bool value = true;
 	};
 
-	template <typename charT, typename traits, typename Alloc>
-	struct is_result<std::basic_string<charT, traits, Alloc>> {
+	template <typename charT, typename traits, typename Allocator>
+	struct is_result<std::basic_string<charT, traits, Allocator>> {
 		static const bool value = true;
 	};
 
 private:
 	static_assert(digit_octets == half_digit_octets * 2, "half_digit must be exactly half the size of digit");
 
-	static constexpr std::size_t karatsuba_cutoff = 1024 / digit_bits;
+	static constexpr std::size_t karatsuba_cutoff = KARATSUBA_CUTOFF / digit_bits;
+	static constexpr std::size_t toom3_cutoff = TOOM3_CUTOFF / digit_bits;
+	static constexpr std::size_t toom4_cutoff = TOOM4_CUTOFF / digit_bits;
+	static constexpr std::size_t ntt_cutoff = NTT_CUTOFF / digit_bits;
+	static constexpr std::size_t burnikel_ziegler_cutoff = BURNIKEL_ZIEGLER_CUTOFF / digit_bits;
+	static constexpr std::size_t newton_cutoff = NEWTON_CUTOFF / digit_bits;
+	static constexpr std::size_t newton_reciprocal_cutoff = NEWTON_RECIPROCAL_CUTOFF / digit_bits;
+	static constexpr std::size_t half_gcd_cutoff = HALF_GCD_CUTOFF / digit_bits;
+	static constexpr std::size_t gcd_half_gcd_cutoff = GCD_HALF_GCD_CUTOFF / digit_bits;
+	static constexpr std::size_t str_dc_cutoff = STR_DC_CUTOFF / digit_bits;
+	static constexpr std::size_t strtouint_dc_cutoff = STRTOUINT_DC_CUTOFF / digit_bits;
+	static constexpr std::size_t radix_powers_cache_size = RADIX_POWERS_CACHE_SIZE / digit_bits;
+	static constexpr std::size_t karatsuba_sqr_cutoff = KARATSUBA_SQR_CUTOFF / digit_bits;
+	static constexpr std::size_t toom3_sqr_cutoff = TOOM3_SQR_CUTOFF / digit_bits;
+	static constexpr std::size_t toom4_sqr_cutoff = TOOM4_SQR_CUTOFF / digit_bits;
+	static constexpr std::size_t ntt_sqr_cutoff = NTT_SQR_CUTOFF / digit_bits;
 	static constexpr double growth_factor = 1.5;
 
+	friend montgomery_context;
+	friend barrett_context;
+	template <std::size_t Bits> friend class uint_t;
+
 	std::size_t _begin;
 	std::size_t _end;
 	container _value_instance;
@@ -277,58 +712,74 @@ public:
 		std::copy(num.begin(), num.end(), end() - sz);
 	}
 
-	container::iterator begin() noexcept {
+	allocator_type get_allocator() const noexcept {
+		return _value.get_allocator();
+	}
+
+	typename container::iterator begin() noexcept {
 		return _value.begin() + _begin;
 	}
 
-	container::const_iterator begin() const noexcept {
+	typename container::const_iterator begin() const noexcept {
 		return _value.cbegin() + _begin;
 	}
 
-	container::iterator end() noexcept {
+	typename container::iterator end() noexcept {
 		return _end ? _value.begin() + _end : _value.end();
 	}
 
-	container::const_iterator end() const noexcept {
+	typename container::const_iterator end() const noexcept {
 		return _end ? _value.cbegin() + _end : _value.cend();
 	}
 
-	container::reverse_iterator rbegin() noexcept {
-		return _end ? container::reverse_iterator(_value.begin() + _end) : _value.rbegin();
+	typename container::reverse_iterator rbegin() noexcept {
+		return _end ? typename container::reverse_iterator(_value.begin() + _end) : _value.rbegin();
 	}
 
-	container::const_reverse_iterator rbegin() const noexcept {
-		return _end ? container::const_reverse_iterator(_value.cbegin() + _end) : _value.crbegin();
+	typename container::const_reverse_iterator rbegin() const noexcept {
+		return _end ? typename container::const_reverse_iterator(_value.cbegin() + _end) : _value.crbegin();
 	}
 
-	container::reverse_iterator rend() noexcept {
-		return container::reverse_iterator(_value.begin() + _begin);
+	typename container::reverse_iterator rend() noexcept {
+		return typename container::reverse_iterator(_value.begin() + _begin);
 	}
 
-	container::const_reverse_iterator rend() const noexcept {
-		return container::const_reverse_iterator(_value.cbegin() + _begin);
+	typename container::const_reverse_iterator rend() const noexcept {
+		return typename container::const_reverse_iterator(_value.cbegin() + _begin);
 	}
 
-	container::reference front() {
+	typename container::reference front() {
 		return *begin();
 	}
 
-	container::const_reference front() const {
+	typename container::const_reference front() const {
 		return *begin();
 	}
 
-	container::reference back() {
+	typename container::reference back() {
 		return *rbegin();
 	}
 
-	container::const_reference back() const {
+	typename container::const_reference back() const {
 		return *rbegin();
 	}
 
 private:
 	// Optimized primitives for operations
+	//
+	// These are constexpr, for the fixed width uint_t; while evaluating them at
+	// compile time the intrinsics (which can't be) are skipped for the portable
+	// versions, with compilers that can tell.
+
+	static constexpr bool _constant_evaluated() {
+	#if defined HAVE____BUILTIN_IS_CONSTANT_EVALUATED
+		return __builtin_is_constant_evaluated();
+	#else
+		return false;
+	#endif
+	}
 
-	static digit _bits(digit x) {
+	static constexpr digit _bits(digit x) {
 	#if defined HAVE____BUILTIN_CLZLL
 		if (digit_octets == sizeof(unsigned long long)) {
 			return x ? digit_bits - __builtin_clzll(x) : 1;
@@ -354,25 +805,55 @@ private:
 		}
 	}
 
-	static digit _mult(digit x, digit y, digit* lo) {
+	// Count of trailing zero bits of x (digit_bits for zero)
+	static digit _ctz(digit x) {
+	#if defined HAVE____BUILTIN_CTZLL
+		if (digit_octets == sizeof(unsigned long long)) {
+			return x ? __builtin_ctzll(x) : digit_bits;
+		}
+	#endif
+	#if defined HAVE____BUILTIN_CTZL
+		if (digit_octets == sizeof(unsigned long)) {
+			return x ? __builtin_ctzl(x) : digit_bits;
+		}
+	#endif
+	#if defined HAVE____BUILTIN_CTZ
+		if (digit_octets == sizeof(unsigned)) {
+			return x ? __builtin_ctz(x) : digit_bits;
+		}
+	#endif
+		{
+			if (!x) {
+				return digit_bits;
+			}
+			digit c = 0;
+			while (!(x & 1)) {
+				x >>= 1;
+				++c;
+			}
+			return c;
+		}
+	}
+
+	static constexpr digit _mult(digit x, digit y, digit* lo) {
 	#if defined HAVE___UMUL128
-		if (digit_bits == 64) {
-			digit h;
-			digit l = _umul128(x, y, &h);  // _umul128(x, y, *hi) -> lo
+		if (digit_bits == 64 && !_constant_evaluated()) {
+			digit h = 0;
+			*lo = _umul128(x, y, &h);  // _umul128(x, y, *hi) -> lo
 			return h;
 		}
 	#endif
 	#if defined HAVE___UMUL64
-		if (digit_bits == 32) {
-			digit h;
-			digit l = _umul64(x, y, &h);  // _umul64(x, y, *hi) -> lo
+		if (digit_bits == 32 && !_constant_evaluated()) {
+			digit h = 0;
+			*lo = _umul64(x, y, &h);  // _umul64(x, y, *hi) -> lo
 			return h;
 		}
 	#endif
 	#if defined HAVE___UMUL32
-		if (digit_bits == 16) {
-			digit h;
-			digit l = _umul32(x, y, &h);  // _umul32(x, y, *hi) -> lo
+		if (digit_bits == 16 && !_constant_evaluated()) {
+			digit h = 0;
+			*lo = _umul32(x, y, &h);  // _umul32(x, y, *hi) -> lo
 			return h;
 		}
 	#endif
@@ -410,24 +891,24 @@ private:
 		}
 	}
 
-	static digit _multadd(digit x, digit y, digit a, digit c, digit* lo) {
+	static constexpr digit _multadd(digit x, digit y, digit a, digit c, digit* lo) {
 	#if defined HAVE___UMUL128 && defined HAVE___ADDCARRY_U64
-		if (digit_bits == 64) {
-			digit h;
+		if (digit_bits == 64 && !_constant_evaluated()) {
+			digit h = 0;
 			digit l = _umul128(x, y, &h);  // _umul128(x, y, *hi) -> lo
 			return h + _addcarry_u64(c, l, a, lo);  // _addcarry_u64(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___UMUL64 && defined HAVE___ADDCARRY_U32
-		if (digit_bits == 32) {
-			digit h;
+		if (digit_bits == 32 && !_constant_evaluated()) {
+			digit h = 0;
 			digit l = _umul64(x, y, &h);  // _umul64(x, y, *hi) -> lo
 			return h + _addcarry_u32(c, l, a, lo);  // _addcarry_u32(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___UMUL32 && defined HAVE___ADDCARRY_U16
-		if (digit_bits == 16) {
-			digit h;
+		if (digit_bits == 16 && !_constant_evaluated()) {
+			digit h = 0;
 			digit l = _umul32(x, y, &h);  // _umul32(x, y, *hi) -> lo
 			return h + _addcarry_u16(c, l, a, lo);  // _addcarry_u16(carryin, x, y, *sum) -> carryout
 		}
@@ -546,39 +1027,39 @@ private:
 		}
 	}
 
-	static digit _addcarry(digit x, digit y, digit c, digit* result) {
+	static constexpr digit _addcarry(digit x, digit y, digit c, digit* result) {
 	#if defined HAVE___ADDCARRY_U64
-		if (digit_bits == 64) {
+		if (digit_bits == 64 && !_constant_evaluated()) {
 			return _addcarry_u64(c, x, y, result);  // _addcarry_u64(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___ADDCARRY_U32
-		if (digit_bits == 32) {
+		if (digit_bits == 32 && !_constant_evaluated()) {
 			return _addcarry_u32(c, x, y, result);  // _addcarry_u32(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___ADDCARRY_U16
-		if (digit_bits == 16) {
+		if (digit_bits == 16 && !_constant_evaluated()) {
 			return _addcarry_u16(c, x, y, result);  // _addcarry_u16(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE____BUILTIN_ADDCLL
-		if (digit_octets == sizeof(unsigned long long)) {
-			unsigned long long carryout;
+		if (digit_octets == sizeof(unsigned long long) && !_constant_evaluated()) {
+			unsigned long long carryout = 0;
 			*result = __builtin_addcll(x, y, c, &carryout);  // __builtin_addcll(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
 	#endif
 	#if defined HAVE____BUILTIN_ADDCL
-		if (digit_octets == sizeof(unsigned long)) {
-			unsigned long carryout;
+		if (digit_octets == sizeof(unsigned long) && !_constant_evaluated()) {
+			unsigned long carryout = 0;
 			*result = __builtin_addcl(x, y, c, &carryout);  // __builtin_addcl(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
 	#endif
 	#if defined HAVE____BUILTIN_ADDC
-		if (digit_octets == sizeof(unsigned)) {
-			unsigned carryout;
+		if (digit_octets == sizeof(unsigned) && !_constant_evaluated()) {
+			unsigned carryout = 0;
 			*result = __builtin_addc(x, y, c, &carryout);  // __builtin_addc(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
@@ -618,39 +1099,39 @@ private:
 		}
 	}
 
-	static digit _subborrow(digit x, digit y, digit c, digit* result) {
+	static constexpr digit _subborrow(digit x, digit y, digit c, digit* result) {
 	#if defined HAVE___SUBBORROW_U64
-		if (digit_bits == 64) {
+		if (digit_bits == 64 && !_constant_evaluated()) {
 			return _subborrow_u64(c, x, y, result);  // _subborrow_u64(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___SUBBORROW_U32
-		if (digit_bits == 64) {
+		if (digit_bits == 64 && !_constant_evaluated()) {
 			return _subborrow_u32(c, x, y, result);  // _subborrow_u32(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE___SUBBORROW_U16
-		if (digit_bits == 64) {
+		if (digit_bits == 64 && !_constant_evaluated()) {
 			return _subborrow_u16(c, x, y, result);  // _subborrow_u16(carryin, x, y, *sum) -> carryout
 		}
 	#endif
 	#if defined HAVE____BUILTIN_SUBCLL
-		if (digit_octets == sizeof(unsigned long long)) {
-			unsigned long long carryout;
+		if (digit_octets == sizeof(unsigned long long) && !_constant_evaluated()) {
+			unsigned long long carryout = 0;
 			*result = __builtin_subcll(x, y, c, &carryout);  // __builtin_subcll(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
 	#endif
 	#if defined HAVE____BUILTIN_SUBCL
-		if (digit_octets == sizeof(unsigned long)) {
-			unsigned long carryout;
+		if (digit_octets == sizeof(unsigned long) && !_constant_evaluated()) {
+			unsigned long carryout = 0;
 			*result = __builtin_subcl(x, y, c, &carryout);  // __builtin_subcl(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
 	#endif
 	#if defined HAVE____BUILTIN_SUBC
-		if (digit_octets == sizeof(unsigned)) {
-			unsigned carryout;
+		if (digit_octets == sizeof(unsigned) && !_constant_evaluated()) {
+			unsigned carryout = 0;
 			*result = __builtin_subc(x, y, c, &carryout);  // __builtin_subc(x, y, carryin, *carryout) -> sum
 			return carryout;
 		}
@@ -690,6 +1171,104 @@ private:
 		}
 	}
 
+	// Inverse of an odd x modulo the digit base
+	static digit _inverse(digit x) {
+		assert(x & 1);
+
+		// Newton iteration, each step doubles the correct bits
+		digit inv = x;
+		for (auto i = digit_bits; i > 2; i >>= 1) {
+			inv *= 2 - x * inv;
+		}
+		return inv;
+	}
+
+	// Reciprocal of a normalized d (with its top bit set), for the division
+	// by invariant integers from "Improved division by invariant integers"
+	// by Niels Moller and Torbjorn Granlund: v = floor((B^2 - 1) / d) - B
+	static digit _reciprocal(digit d) {
+		assert(d >> (digit_bits - 1));
+		digit v;
+		_divmod(~d, ~static_cast<digit>(0), d, &v);
+		return v;
+	}
+
+	// Divides (u1, u0) by a normalized d (for u1 < d) with its reciprocal v,
+	// without dividing, returns the remainder.
+	static digit _divmod_preinv(digit u1, digit u0, digit d, digit v, digit* result) {
+		digit q0;
+		digit q1 = _mult(v, u1, &q0);
+		auto carry = _addcarry(q0, u0, 0, &q0);
+		_addcarry(q1, u1 + 1, carry, &q1);
+		digit r = u0 - q1 * d;
+		if (r > q0) {
+			--q1;
+			r += d;
+		}
+		if (r >= d) {
+			++q1;
+			r -= d;
+		}
+		*result = q1;
+		return r;
+	}
+
+	// Same as above, but only the remainder (the first adjustment, which is
+	// hard to predict, is done without branching)
+	static digit _mod_preinv(digit u1, digit u0, digit d, digit v) {
+		digit q0;
+		digit q1 = _mult(v, u1, &q0);
+		auto carry = _addcarry(q0, u0, 0, &q0);
+		q1 += u1 + 1 + carry;
+		digit r = u0 - q1 * d;
+		r += d & (0 - static_cast<digit>(r > q0));
+		if (r >= d) {
+			r -= d;
+		}
+		return r;
+	}
+
+public:
+	// A single digit divisor, normalized and with its reciprocal, so that
+	// dividing by it (over and over) only takes multiplications.
+	struct divisor {
+		digit value;
+		digit shift;       // normalizing shift
+		digit normalized;  // value << shift
+		digit reciprocal;  // of normalized
+
+		divisor() :
+			value(0),
+			shift(0),
+			normalized(0),
+			reciprocal(0) { }
+
+		explicit divisor(digit d) :
+			value(d) {
+			if (!d) {
+				throw std::domain_error("Error: division or modulus by 0");
+			}
+			shift = digit_bits - _bits(d);
+			normalized = d << shift;
+			reciprocal = _reciprocal(normalized);
+		}
+
+		// Divides (r, x) by the divisor, for r less than it, returns the
+		// remainder. (r * B + x) * 2^shift is less than B * normalized, and
+		// dividing it by normalized gives the same quotient.
+		digit divmod(digit r, digit x, digit* quotient) const {
+			auto u1 = (r << shift) | ((x >> 1) >> (digit_bits - 1 - shift));
+			return _divmod_preinv(u1, x << shift, normalized, reciprocal, quotient) >> shift;
+		}
+
+		digit mod(digit r, digit x) const {
+			auto u1 = (r << shift) | ((x >> 1) >> (digit_bits - 1 - shift));
+			return _mod_preinv(u1, x << shift, normalized, reciprocal) >> shift;
+		}
+	};
+
+private:
+
 	// Helper functions
 
 	void trim(digit mask = 0) {
@@ -708,37 +1287,11 @@ private:
 	}
 
 	static constexpr char chr(int ord) {
-		constexpr const char _[256] = {
-			'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
-			'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n',
-			'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
-		};
-		return _[ord];
+		return static_cast<char>(ord < 10 ? '0' + ord : 'a' - 10 + ord);
 	}
 
 	static constexpr int ord(int chr) {
-		constexpr const int _[256] = {
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
-
-			-1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
-			25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
-			-1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
-			25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
-
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		};
-		return _[chr];
+		return chr >= '0' && chr <= '9' ? chr - '0' : (chr | 0x20) >= 'a' && (chr | 0x20) <= 'z' ? (chr | 0x20) - 'a' + 10 : -1;
 	}
 
 public:
@@ -792,14 +1345,20 @@ public:
 		return _[base - 1];
 	}
 
-	static const uinteger_t uint_0() {
-		static uinteger_t uint_0(0);
-		return uint_0;
+	// Small numbers don't allocate, so these need no (guarded) statics to copy
+	static uinteger_t uint_0() {
+		return uinteger_t();
+	}
+
+	static uinteger_t uint_1() {
+		return uinteger_t(1);
 	}
 
-	static const uinteger_t uint_1() {
-		static uinteger_t uint_1(1);
-		return uint_1;
+	// One with the given allocator, for the bigger numbers built from it
+	static uinteger_t uint_1(const allocator_type& alloc) {
+		uinteger_t result(alloc);
+		result = uint_1();
+		return result;
 	}
 
 private:
@@ -868,7 +1427,7 @@ public:
 	}
 
 	static uinteger_t bitwise_and(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_and(result, lhs, rhs);
 		return result;
 	}
@@ -933,7 +1492,7 @@ public:
 		return result;
 	}
 	static uinteger_t bitwise_or(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_or(result, lhs, rhs);
 		return result;
 	}
@@ -999,7 +1558,7 @@ public:
 	}
 
 	static uinteger_t bitwise_xor(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_xor(result, lhs, rhs);
 		return result;
 	}
@@ -1056,7 +1615,7 @@ public:
 	}
 
 	static uinteger_t bitwise_inv(const uinteger_t& lhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_inv(result, lhs);
 		return result;
 	}
@@ -1066,8 +1625,8 @@ public:
 			return lhs;
 		}
 
-		uinteger_t shifts_q;
-		uinteger_t shifts_r;
+		uinteger_t shifts_q(lhs.get_allocator());
+		uinteger_t shifts_r(lhs.get_allocator());
 		auto _digit_bits = digit_bits;
 		auto uint_digit_bits = uinteger_t(_digit_bits);
 		divmod(shifts_q, shifts_r, rhs, uint_digit_bits);
@@ -1108,8 +1667,8 @@ public:
 
 		auto lhs_sz = lhs.size();
 
-		uinteger_t shifts_q;
-		uinteger_t shifts_r;
+		uinteger_t shifts_q(lhs.get_allocator());
+		uinteger_t shifts_r(lhs.get_allocator());
 		auto _digit_bits = digit_bits;
 		auto uint_digit_bits = uinteger_t(_digit_bits);
 		divmod(shifts_q, shifts_r, rhs, uint_digit_bits);
@@ -1150,7 +1709,7 @@ public:
 	}
 
 	static uinteger_t bitwise_lshift(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_lshift(result, lhs, rhs);
 		return result;
 	}
@@ -1168,8 +1727,8 @@ public:
 			return lhs;
 		}
 
-		uinteger_t shifts_q;
-		uinteger_t shifts_r;
+		uinteger_t shifts_q(lhs.get_allocator());
+		uinteger_t shifts_r(lhs.get_allocator());
 		auto uint_digit_bits = uinteger_t(_digit_bits);
 		divmod(shifts_q, shifts_r, rhs, uint_digit_bits);
 		std::size_t shifts = static_cast<std::size_t>(shifts_q);
@@ -1211,8 +1770,8 @@ public:
 			return result;
 		}
 
-		uinteger_t shifts_q;
-		uinteger_t shifts_r;
+		uinteger_t shifts_q(lhs.get_allocator());
+		uinteger_t shifts_r(lhs.get_allocator());
 		auto uint_digit_bits = uinteger_t(_digit_bits);
 		divmod(shifts_q, shifts_r, rhs, uint_digit_bits);
 		std::size_t shifts = static_cast<std::size_t>(shifts_q);
@@ -1250,7 +1809,7 @@ public:
 	}
 
 	static uinteger_t bitwise_rshift(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		bitwise_rshift(result, lhs, rhs);
 		return result;
 	}
@@ -1404,7 +1963,7 @@ public:
 	}
 
 	static uinteger_t add(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		add(result, lhs, rhs);
 		return result;
 	}
@@ -1513,7 +2072,7 @@ public:
 	}
 
 	static uinteger_t sub(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
+		uinteger_t result(lhs.get_allocator());
 		sub(result, lhs, rhs);
 		return result;
 	}
@@ -1527,7 +2086,7 @@ public:
 		assert(rhs_sz == 1); (void)(rhs_sz);
 		auto n = rhs.front();
 
-		uinteger_t tmp;
+		uinteger_t tmp(lhs.get_allocator(), result._value.scratch());
 		tmp.resize(lhs_sz + 1, 0);
 
 		auto it_lhs = lhs.begin();
@@ -1563,8 +2122,11 @@ public:
 			return single_mult(result, rhs, lhs);
 		}
 
-		uinteger_t tmp;
-		tmp.resize(lhs_sz + rhs_sz, 0);
+		// Works in the result (reusing its space), unless it's also an argument:
+		uinteger_t tmp(lhs.get_allocator(), result._value.scratch());
+		auto& acc = &result._value == &lhs._value || &result._value == &rhs._value ? tmp : result;
+		acc.resize(lhs_sz + rhs_sz);
+		std::fill(acc.begin(), acc.end(), 0);
 
 		auto it_lhs = lhs.begin();
 		auto it_lhs_e = lhs.end();
@@ -1572,7 +2134,7 @@ public:
 		auto it_rhs = rhs.begin();
 		auto it_rhs_e = rhs.end();
 
-		auto it_result = tmp.begin();
+		auto it_result = acc.begin();
 		auto it_result_s = it_result;
 		auto it_result_l = it_result;
 
@@ -1593,109 +2155,256 @@ public:
 			}
 		}
 
-		tmp.resize(it_result_l - it_result_s); // shrink
+		acc.resize(it_result_l - it_result_s); // shrink
 
-		result = std::move(tmp);
+		if (&acc == &tmp) {
+			result = std::move(tmp);
+		}
 
 		// Finish up
 		result.trim();
 		return result;
 	}
 
-	// A helper for Karatsuba multiplication to split a number in two, at n.
-	static std::pair<const uinteger_t, const uinteger_t> karatsuba_mult_split(const uinteger_t& num, std::size_t n) {
-		const uinteger_t a(num, num._begin, num._begin + n);
-		const uinteger_t b(num, num._begin + n, num._end);
-		return std::make_pair(std::move(a), std::move(b));
-	}
-
-	// If rhs has at least twice the digits of lhs, and lhs is big enough that
-	// Karatsuba would pay off *if* the inputs had balanced sizes.
-	// View rhs as a sequence of slices, each with lhs.size() digits,
-	// and multiply the slices by lhs, one at a time.
-	static uinteger_t& karatsuba_lopsided_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff) {
-		auto lhs_sz = lhs.size();
-		auto rhs_sz = rhs.size();
+	// Truncated long multiplication, only calculates the lowest sz digits
+	// of the product (the product modulo B^sz).
+	static uinteger_t& long_mult_low(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t sz) {
+		auto lhs_sz = std::min(lhs.size(), sz);
+		auto rhs_sz = std::min(rhs.size(), sz);
 
-		assert(lhs_sz > cutoff);
-		assert(2 * lhs_sz <= rhs_sz);
+		uinteger_t tmp(lhs.get_allocator(), result._value.scratch());
+		tmp.resize(sz, 0);
 
-		auto rhs_begin = rhs._begin;
-		std::size_t shift = 0;
+		auto a = lhs.data();
+		auto b = rhs.data();
+		auto r = tmp.data();
 
-		uinteger_t r;
-		while (rhs_sz > 0) {
-			// Multiply the next slice of rhs by lhs and add into result:
-			auto slice_size = std::min(lhs_sz, rhs_sz);
-			const uinteger_t rhs_slice(rhs, rhs_begin, rhs_begin + slice_size);
-			uinteger_t p;
-			karatsuba_mult(p, lhs, rhs_slice, cutoff);
-			uinteger_t rs(r, shift, 0);
-			add(rs, rs, p);
-			shift += slice_size;
-			rhs_sz -= slice_size;
-			rhs_begin += slice_size;
+		for (std::size_t i = 0; i < lhs_sz; ++i) {
+			if (auto a_i = a[i]) {
+				auto j_e = std::min(rhs_sz, sz - i);
+				digit carry = 0;
+				for (std::size_t j = 0; j < j_e; ++j) {
+					carry = _multadd(b[j], a_i, r[i + j], carry, &r[i + j]);
+				}
+				if (i + j_e < sz) {
+					r[i + j_e] = carry;
+				}
+			}
 		}
 
-		result = std::move(r);
+		result = std::move(tmp);
+
+		// Finish up
+		result.trim();
 		return result;
 	}
 
-	// Karatsuba multiplication
-	static uinteger_t& karatsuba_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff = 1) {
+	// Truncated long multiplication, only calculates the digits of the product
+	// from the given column up (as if it was shifted right by that many digits).
+	// The carries from the columns below are lost, so the result can fall short
+	// by up to the number of digits of the smallest operand.
+	static uinteger_t& long_mult_high(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t column) {
 		auto lhs_sz = lhs.size();
 		auto rhs_sz = rhs.size();
 
-		if (lhs_sz > rhs_sz) {
-			// rhs should be the largest:
-			return karatsuba_mult(result, rhs, lhs, cutoff);
+		if (lhs_sz + rhs_sz <= column) {
+			result = uint_0();
+			return result;
 		}
 
-		if (lhs_sz <= cutoff) {
-			return long_mult(result, lhs, rhs);
-		}
+		uinteger_t tmp(lhs.get_allocator(), result._value.scratch());
+		tmp.resize(lhs_sz + rhs_sz - column, 0);
 
-		// If a is too small compared to b, splitting on b gives a degenerate case
-		// in which Karatsuba may be (even much) less efficient than long multiplication.
-		if (2 * lhs_sz <= rhs_sz) {
-			return karatsuba_lopsided_mult(result, lhs, rhs, cutoff);
+		auto a = lhs.data();
+		auto b = rhs.data();
+		auto r = tmp.data();
+
+		for (std::size_t i = 0; i < lhs_sz; ++i) {
+			auto j = column > i ? column - i : 0;
+			if (j >= rhs_sz) {
+				continue;
+			}
+			if (auto a_i = a[i]) {
+				digit carry = 0;
+				for (; j < rhs_sz; ++j) {
+					carry = _multadd(b[j], a_i, r[i + j - column], carry, &r[i + j - column]);
+				}
+				r[i + rhs_sz - column] = carry;
+			}
 		}
 
-		// Karatsuba:
-		//
-		//                  A      B
-		//               x  C      D
-		//     ---------------------
-		//                 AD     BD
-		//       AC        BC
-		//     ---------------------
-		//       AC    AD + BC    BD
-		//
-		//  AD + BC  =
-		//  AC + AD + BC + BD - AC - BD
+		result = std::move(tmp);
+
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	// A helper for Karatsuba multiplication to split a number in two, at n
+	// (copying the halves into hi and lo, usually scratch temporaries).
+	static void karatsuba_mult_split(uinteger_t& hi, uinteger_t& lo, const uinteger_t& num, std::size_t n) {
+		const uinteger_t a(num, num._begin, num._begin + n);
+		const uinteger_t b(num, num._begin + n, num._end);
+		lo = a;
+		hi = b;
+	}
+
+	// Long squaring, each cross product is only calculated once and doubled
+	static uinteger_t& long_sqr(uinteger_t& result, const uinteger_t& lhs) {
+		auto lhs_sz = lhs.size();
+
+		// Works in the result (reusing its space), unless it's also the argument:
+		uinteger_t tmp(lhs.get_allocator(), result._value.scratch());
+		auto& acc = &result._value == &lhs._value ? tmp : result;
+		acc.resize(lhs_sz * 2);
+		std::fill(acc.begin(), acc.end(), 0);
+
+		auto it_lhs = lhs.begin();
+		auto it_lhs_e = lhs.end();
+
+		auto it_result = acc.begin();
+
+		// Cross products (a[i] * a[j] for i < j):
+		for (auto it_lhs_i = it_lhs; it_lhs_i != it_lhs_e; ++it_lhs_i) {
+			auto _it_result = it_result + (it_lhs_i - it_lhs) * 2 + 1;
+			if (auto lhs_it_val = *it_lhs_i) {
+				digit carry = 0;
+				for (auto _it_lhs = it_lhs_i + 1; _it_lhs != it_lhs_e; ++_it_lhs, ++_it_result) {
+					carry = _multadd(*_it_lhs, lhs_it_val, *_it_result, carry, &*_it_result);
+				}
+				*_it_result = carry;
+			}
+		}
+
+		// Double them and add the squares (a[i] * a[i]):
+		digit shifted = 0;
+		digit carry = 0;
+		for (; it_lhs != it_lhs_e; ++it_lhs) {
+			digit lo;
+			auto hi = _mult(*it_lhs, *it_lhs, &lo);
+			auto v = (*it_result << 1) | shifted;
+			shifted = *it_result >> (digit_bits - 1);
+			carry = _addcarry(v, lo, carry, &*it_result++);
+			v = (*it_result << 1) | shifted;
+			shifted = *it_result >> (digit_bits - 1);
+			carry = _addcarry(v, hi, carry, &*it_result++);
+		}
+		assert(!carry && !shifted);
+
+		if (&acc == &tmp) {
+			result = std::move(tmp);
+		}
+
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	using mult_function = uinteger_t& (*)(uinteger_t&, const uinteger_t&, const uinteger_t&, std::size_t);
+
+	// If rhs has more digits than lhs, and lhs is big enough that mult_fn
+	// would pay off *if* the inputs had balanced sizes.
+	// View rhs as a sequence of slices, each with lhs.size() digits,
+	// and multiply the slices by lhs, one at a time.
+	static uinteger_t& lopsided_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff, mult_function mult_fn) {
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
+
+		assert(lhs_sz > cutoff);
+		assert(lhs_sz < rhs_sz);
+
+		uinteger_t r(lhs.get_allocator(), result._value.scratch());
+		r.resize(lhs_sz + rhs_sz, 0);
+
+		// Slices are added from the top one down, that way the trimming done
+		// by add() never leaves r shorter than the shift of the next slice.
+		auto shift = ((rhs_sz - 1) / lhs_sz) * lhs_sz;
+		auto slice_size = rhs_sz - shift;
+		while (true) {
+			// Multiply the next slice of rhs by lhs and add into result:
+			const uinteger_t rhs_slice(rhs, rhs._begin + shift, rhs._begin + shift + slice_size);
+			uinteger_t p(lhs.get_allocator(), true);
+			mult_fn(p, lhs, rhs_slice, cutoff);
+			uinteger_t rs(r, shift, 0);
+			add(rs, rs, p);
+			if (!shift) {
+				break;
+			}
+			shift -= lhs_sz;
+			slice_size = lhs_sz;
+		}
+
+		result = std::move(r);
+
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	// If rhs has at least twice the digits of lhs, and lhs is big enough that
+	// Karatsuba would pay off *if* the inputs had balanced sizes.
+	static uinteger_t& karatsuba_lopsided_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff) {
+		assert(2 * lhs.size() <= rhs.size());
+		return lopsided_mult(result, lhs, rhs, cutoff, karatsuba_mult);
+	}
+
+	// Karatsuba multiplication
+	static uinteger_t& karatsuba_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
+
+		if (lhs_sz > rhs_sz) {
+			// rhs should be the largest:
+			return karatsuba_mult(result, rhs, lhs, cutoff);
+		}
+
+		if (lhs_sz <= cutoff) {
+			return long_mult(result, lhs, rhs);
+		}
+
+		// If a is too small compared to b, splitting on b gives a degenerate case
+		// in which Karatsuba may be (even much) less efficient than long multiplication.
+		if (2 * lhs_sz <= rhs_sz) {
+			return karatsuba_lopsided_mult(result, lhs, rhs, cutoff);
+		}
+
+		// Karatsuba:
+		//
+		//                  A      B
+		//               x  C      D
+		//     ---------------------
+		//                 AD     BD
+		//       AC        BC
+		//     ---------------------
+		//       AC    AD + BC    BD
+		//
+		//  AD + BC  =
+		//  AC + AD + BC + BD - AC - BD
 		//  (A + B) (C + D) - AC - BD
 
 		// Calculate the split point near the middle of the largest (rhs).
 		auto shift = rhs_sz >> 1;
 
-		// Split to get A and B:
-		const auto lhs_pair = karatsuba_mult_split(lhs, shift);
-		const auto& A = lhs_pair.second; // hi
-		const auto& B = lhs_pair.first;  // lo
+		// Split to get A (hi) and B (lo):
+		uinteger_t A(lhs.get_allocator(), true), B(lhs.get_allocator(), true);
+		karatsuba_mult_split(A, B, lhs, shift);
 
-		// Split to get C and D:
-		const auto rhs_pair = karatsuba_mult_split(rhs, shift);
-		const auto& C = rhs_pair.second; // hi
-		const auto& D = rhs_pair.first;  // lo
+		// Split to get C (hi) and D (lo):
+		uinteger_t C(lhs.get_allocator(), true), D(lhs.get_allocator(), true);
+		karatsuba_mult_split(C, D, rhs, shift);
 
-		// Get the pieces:
-		uinteger_t AC;
+		// Get the pieces (all but BD are scratch; BD goes in the result, reusing
+		// its space, as nothing reads lhs or rhs after the split):
+		uinteger_t AC(lhs.get_allocator(), true);
 		karatsuba_mult(AC, A, C, cutoff);
 
-		uinteger_t BD;
+		auto& BD = result;
 		karatsuba_mult(BD, B, D, cutoff);
-		uinteger_t AD_BC, AB, CD;
-		karatsuba_mult(AD_BC, A + B, C + D, cutoff);
+
+		uinteger_t AD_BC(lhs.get_allocator(), true), AB(lhs.get_allocator(), true), CD(lhs.get_allocator(), true);
+		add(AB, A, B);
+		add(CD, C, D);
+		karatsuba_mult(AD_BC, AB, CD, cutoff);
 		AD_BC -= AC;
 		AD_BC -= BD;
 
@@ -1708,837 +2417,4790 @@ public:
 		uinteger_t BDs(BD, shift, 0);
 		add(BDs, BDs, AD_BC);
 
-		result = std::move(BD);
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	// Karatsuba squaring
+	//
+	//          A      B
+	//    ---------------  ^2
+	//         AA     BB
+	//    + AB + AB
+	//
+	//  2AB  =  (A + B)^2 - AA - BB
+	static uinteger_t& karatsuba_sqr(uinteger_t& result, const uinteger_t& lhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+
+		if (lhs_sz <= cutoff) {
+			return long_sqr(result, lhs);
+		}
+
+		// Calculate the split point near the middle.
+		auto shift = lhs_sz >> 1;
+
+		// Split to get A (hi) and B (lo):
+		uinteger_t A(lhs.get_allocator(), true), B(lhs.get_allocator(), true);
+		karatsuba_mult_split(A, B, lhs, shift);
+
+		// Get the pieces (all but BB are scratch; BB goes in the result, reusing
+		// its space, as nothing reads lhs after the split):
+		uinteger_t AA(lhs.get_allocator(), true);
+		karatsuba_sqr(AA, A, cutoff);
+
+		auto& BB = result;
+		karatsuba_sqr(BB, B, cutoff);
+
+		uinteger_t AB(lhs.get_allocator(), true), AB2(lhs.get_allocator(), true);
+		add(AB, A, B);
+		karatsuba_sqr(AB2, AB, cutoff);
+		AB2 -= AA;
+		AB2 -= BB;
+
+		// Join the pieces, AA and BB (can't overlap) into BB:
+		BB.reserve(shift * 2 + AA.size());
+		BB.resize(shift * 2, 0);
+		BB.append(AA);
+
+		// And add AB2 to the middle: (AA           BB) + (    2AB    ):
+		uinteger_t BBs(BB, shift, 0);
+		add(BBs, BBs, AB2);
 
 		// Finish up
 		result.trim();
 		return result;
 	}
 
-	static uinteger_t& mult(uinteger_t& lhs, const uinteger_t& rhs) {
-		// Hard to see how this could have a further optimized implementation.
-		return mult(lhs, lhs, rhs);
+	// Exact division by a single odd digit (in place), used for interpolation.
+	// Instead of dividing, multiplies by the inverse of n modulo the digit base.
+	static uinteger_t& single_divexact(uinteger_t& lhs, digit n) {
+		auto inv = _inverse(n);
+
+		auto it_lhs = lhs.begin();
+		auto it_lhs_e = lhs.end();
+
+		digit carry = 0;
+		for (; it_lhs != it_lhs_e; ++it_lhs) {
+			digit t;
+			auto borrow = _subborrow(*it_lhs, carry, 0, &t);
+			digit q = t * inv;
+			*it_lhs = q;
+			digit lo;
+			carry = _mult(q, n, &lo) + borrow;
+		}
+		assert(!carry);
+
+		// Finish up
+		lhs.trim();
+		return lhs;
 	}
 
-	static uinteger_t& mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
-		// First try saving some calculations:
-		if (!lhs || !rhs) {
-			result = uint_0();
-			return result;
+	// A helper to get the i-th piece, n digits wide, of a number.
+	static uinteger_t split_piece(const uinteger_t& num, std::size_t n, std::size_t i) {
+		auto num_sz = num.size();
+		auto b = std::min(num_sz, i * n);
+		auto e = std::min(num_sz, b + n);
+
+		uinteger_t piece(num.get_allocator());
+		piece.resize(e - b);
+		std::copy(num.begin() + b, num.begin() + e, piece.begin());
+
+		// Finish up
+		piece.trim();
+		return piece;
+	}
+
+	// A helper for Toom-Cook multiplication to get the difference of two
+	// evaluations, returns true if the result is negative: result = |lhs - rhs|
+	static bool toom_mult_diff(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		if (compare(lhs, rhs) < 0) {
+			sub(result, rhs, lhs);
+			return true;
 		}
-		if (compare(lhs, uint_1()) == 0) {
-			result = rhs;
-			return result;
+		sub(result, lhs, rhs);
+		return false;
+	}
+
+	// A helper for Toom-Cook multiplication to get the even and odd halves of
+	// the evaluations at +1 and -1: even = (r1 + rm1) / 2 and odd = (r1 - rm1) / 2
+	static void toom_mult_halves(uinteger_t& even, uinteger_t& odd, const uinteger_t& r1, const uinteger_t& rm1, bool rm1_neg) {
+		if (rm1_neg) {
+			sub(even, r1, rm1);
+			add(odd, r1, rm1);
+		} else {
+			add(even, r1, rm1);
+			sub(odd, r1, rm1);
 		}
-		if (compare(rhs, uint_1()) == 0) {
-			result = lhs;
-			return result;
+		even >>= 1;
+		odd >>= 1;
+	}
+
+	// A helper for Toom-Cook multiplication to join the coefficients into the result,
+	// each coefficient is added shifted n digits from the previous one.
+	static uinteger_t& toom_mult_join(uinteger_t& result, std::size_t size, std::size_t n, std::initializer_list<std::reference_wrapper<const uinteger_t>> coeffs) {
+		uinteger_t r(result.get_allocator(), result._value.scratch());
+		r.resize(size, 0);
+
+		// Coefficients are added from the top one down, that way the trimming
+		// done by add() never leaves r shorter than the shift of the next one.
+		auto shift = coeffs.size() * n;
+		auto it = coeffs.end();
+		while (it != coeffs.begin()) {
+			--it;
+			shift -= n;
+			uinteger_t rs(r, shift, 0);
+			add(rs, rs, *it);
 		}
 
-		return karatsuba_mult(result, lhs, rhs, karatsuba_cutoff);
-	}
+		result = std::move(r);
 
-	static uinteger_t mult(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t result;
-		mult(result, lhs, rhs);
+		// Finish up
+		result.trim();
 		return result;
 	}
 
-	// Single word long division
-	// Fastests, but ONLY for single sized rhs
-	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> single_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+	// A helper for Toom-3 to interpolate the coefficients of the product
+	// from its evaluations at 0, 1, -1, 2 and infinity, and join them.
+	//
+	//  c2 = (r1 + rm1) / 2 - c0 - c4
+	//  c3 = ((r2 - c0 - 4c2 - 16c4) / 2 - (r1 - rm1) / 2) / 3
+	//  c1 = (r1 - rm1) / 2 - c3
+	static uinteger_t& toom3_interpolate(uinteger_t& result, std::size_t size, std::size_t n, const uinteger_t& r0, const uinteger_t& r1, const uinteger_t& rm1, bool rm1_neg, const uinteger_t& r2, const uinteger_t& rinf) {
+		uinteger_t c2(r0.get_allocator(), true), c13(r0.get_allocator(), true);
+		toom_mult_halves(c2, c13, r1, rm1, rm1_neg);
+		c2 -= r0;
+		c2 -= rinf;
+
+		auto c3 = r2;
+		c3 -= r0;
+		c3 -= c2 << 2;
+		c3 -= rinf << 4;
+		c3 >>= 1;
+		c3 -= c13;
+		single_divexact(c3, 3);
+
+		auto& c1 = c13;
+		c1 -= c3;
+
+		return toom_mult_join(result, size, n, {r0, c1, c2, c3, rinf});
+	}
+
+	// A helper for Toom-4 to interpolate the coefficients of the product
+	// from its evaluations at 0, 1, -1, 2, -2, 1/2 and infinity, and join them.
+	//
+	//  e1 = (r1 + rm1) / 2 - c0 - c6                 = c2 + c4
+	//  e2 = ((r2 + rm2) / 2 - c0 - 64c6) / 4         = c2 + 4c4
+	//  o1 = (r1 - rm1) / 2                           = c1 + c3 + c5
+	//  o2 = (r2 - rm2) / 4                           = c1 + 4c3 + 16c5
+	//  h  = (rh - 64c0 - 16c2 - 4c4 - c6) / 2         = 16c1 + 4c3 + c5
+	//  x  = (o2 - o1) / 3                            = c3 + 5c5
+	//  y  = (16o1 - h) / 3                           = 4c3 + 5c5
+	//
+	//  c4 = (e2 - e1) / 3
+	//  c2 = e1 - c4
+	//  c3 = (y - x) / 3
+	//  c5 = (x - c3) / 5
+	//  c1 = o1 - c3 - c5
+	static uinteger_t& toom4_interpolate(uinteger_t& result, std::size_t size, std::size_t n, const uinteger_t& r0, const uinteger_t& r1, const uinteger_t& rm1, bool rm1_neg, const uinteger_t& r2, const uinteger_t& rm2, bool rm2_neg, const uinteger_t& rh, const uinteger_t& rinf) {
+		uinteger_t e1(r0.get_allocator(), true), o1(r0.get_allocator(), true);
+		toom_mult_halves(e1, o1, r1, rm1, rm1_neg);
+		e1 -= r0;
+		e1 -= rinf;
+
+		uinteger_t e2(r0.get_allocator(), true), o2(r0.get_allocator(), true);
+		toom_mult_halves(e2, o2, r2, rm2, rm2_neg);
+		e2 -= r0;
+		e2 -= rinf << 6;
+		e2 >>= 2;
+		o2 >>= 1;
+
+		auto h = rh;
+		h -= r0 << 6;
+		h -= rinf;
+
+		auto c4 = e2;
+		c4 -= e1;
+		single_divexact(c4, 3);
+
+		auto& c2 = e1;
+		c2 -= c4;
+
+		h -= c2 << 4;
+		h -= c4 << 2;
+		h >>= 1;
+
+		auto x = o2;
+		x -= o1;
+		single_divexact(x, 3);
+
+		auto y = o1 << 4;
+		y -= h;
+		single_divexact(y, 3);
+
+		auto c3 = y;
+		c3 -= x;
+		single_divexact(c3, 3);
+
+		auto c5 = x;
+		c5 -= c3;
+		single_divexact(c5, 5);
+
+		auto& c1 = o1;
+		c1 -= c3;
+		c1 -= c5;
+
+		return toom_mult_join(result, size, n, {r0, c1, c2, c3, c4, c5, rinf});
+	}
+
+	// Unbalanced Toom-Cook 3-way multiplication (Toom-32)
+	// For rhs with around 1.5 to 3 times the digits of lhs, splits rhs in three
+	// and lhs in two pieces, and evaluates at 0, 1, -1 and infinity.
+	static uinteger_t& toom32_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff) {
 		auto lhs_sz = lhs.size();
 		auto rhs_sz = rhs.size();
 
-		assert(rhs_sz == 1); (void)(rhs_sz);
-		auto n = rhs.front();
-
-		auto rit_lhs = lhs.rbegin();
-		auto rit_lhs_e = lhs.rend();
+		auto n = (rhs_sz + 2) / 3;
+		assert(n < lhs_sz && lhs_sz <= 2 * n);
 
-		auto q = uint_0();
-		q.resize(lhs_sz, 0);
-		auto rit_q = q.rbegin();
+		// Toom-32:
+		//
+		//     A(x) =             a1 x  +  a0
+		//     B(x) = b2 x^2  +   b1 x  +  b0
+		//     ------------------------------
+		//     C(x) = c3 x^3 + c2 x^2 + c1 x + c0
+		//
+		//  r0   = C(0)   = c0
+		//  r1   = C(1)   = c0 + c1 + c2 + c3
+		//  rm1  = C(-1)  = c0 - c1 + c2 - c3
+		//  rinf = C(inf) = c3
+		//
+		//  c2 = (r1 + rm1) / 2 - c0
+		//  c1 = (r1 - rm1) / 2 - c3
+
+		// Split to get the pieces:
+		auto a0 = split_piece(lhs, n, 0);
+		auto a1 = split_piece(lhs, n, 1);
+		auto b0 = split_piece(rhs, n, 0);
+		auto b1 = split_piece(rhs, n, 1);
+		auto b2 = split_piece(rhs, n, 2);
+
+		// Evaluate:
+		uinteger_t pm1(lhs.get_allocator(), true);
+		bool pm1_neg = toom_mult_diff(pm1, a0, a1);
+		auto p1 = a0 + a1;
+
+		auto b02 = b0 + b2;
+		uinteger_t qm1(lhs.get_allocator(), true);
+		bool qm1_neg = toom_mult_diff(qm1, b02, b1);
+		auto q1 = b02 + b1;
 
-		digit r = 0;
-		for (; rit_lhs != rit_lhs_e; ++rit_lhs, ++rit_q) {
-			r = _divmod(r, *rit_lhs, n, &*rit_q);
-		}
+		// Get the pieces:
+		const auto alloc = lhs.get_allocator();
+		uinteger_t r0(alloc, true), r1(alloc, true), rm1(alloc, true), rinf(alloc, true);
+		toom3_mult(r0, a0, b0, cutoff);
+		toom3_mult(r1, p1, q1, cutoff);
+		toom3_mult(rm1, pm1, qm1, cutoff);
+		toom3_mult(rinf, a1, b2, cutoff);
 
-		q.trim();
+		// Interpolate:
+		uinteger_t c2(lhs.get_allocator(), true), c1(lhs.get_allocator(), true);
+		toom_mult_halves(c2, c1, r1, rm1, pm1_neg != qm1_neg);
+		c2 -= r0;
+		c1 -= rinf;
 
-		quotient = std::move(q);
-		remainder = r;
-		return std::make_pair(std::ref(quotient), std::ref(remainder));
+		return toom_mult_join(result, lhs_sz + rhs_sz, n, {r0, c1, c2, rinf});
 	}
 
-	// Implementation of Knuth's Algorithm D
-	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> knuth_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t v(lhs);
-		uinteger_t w(rhs);
-
-		auto v_size = v.size();
-		auto w_size = w.size();
-		assert(v_size >= w_size && w_size >= 2);
+	// Toom-Cook 3-way multiplication (Toom-33)
+	static uinteger_t& toom3_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
 
-		// D1. normalize: shift rhs left so that its top digit is >= 63 bits.
-		// shift lhs left by the same amount. Results go into w and v.
-		auto d = uinteger_t(digit_bits - _bits(w.back()));
-		v <<= d;
-		w <<= d;
+		if (lhs_sz > rhs_sz) {
+			// rhs should be the largest:
+			return toom3_mult(result, rhs, lhs, cutoff);
+		}
 
-		if (*v.rbegin() >= *w.rbegin()) {
-			v.append(0);
+		if (lhs_sz <= cutoff) {
+			return karatsuba_mult(result, lhs, rhs, karatsuba_cutoff);
 		}
-		v_size = v.size();
-		v.append(0);
 
-		// Now *v.rbegin() < *w.rbegin() so quotient has at most
-		// (and usually exactly) k = v.size() - w.size() digits.
-		auto k = v_size - w_size;
-		auto q = uint_0();
-		q.resize(k + 1, 0);
+		// Calculate the split point at a third of the largest (rhs).
+		auto n = (rhs_sz + 2) / 3;
 
-		auto rit_q = q.rend() - (k + 1);
+		// If lhs is too small compared to rhs, use the unbalanced variants.
+		if (lhs_sz <= n) {
+			return lopsided_mult(result, lhs, rhs, cutoff, toom3_mult);
+		}
+		if (lhs_sz <= 2 * n) {
+			return toom32_mult(result, lhs, rhs, cutoff);
+		}
 
-		auto it_v_b = v.begin();
-		auto it_v_k = it_v_b + k;
+		// Toom-33:
+		//
+		//     A(x) = a2 x^2  +  a1 x  +  a0
+		//     B(x) = b2 x^2  +  b1 x  +  b0
+		//     -----------------------------
+		//     C(x) = c4 x^4 + c3 x^3 + c2 x^2 + c1 x + c0
+		//
+		//  r0   = C(0)   = c0
+		//  r1   = C(1)   = c0 +  c1 +  c2 +  c3 +   c4
+		//  rm1  = C(-1)  = c0 -  c1 +  c2 -  c3 +   c4
+		//  r2   = C(2)   = c0 + 2c1 + 4c2 + 8c3 + 16c4
+		//  rinf = C(inf) = c4
+		//
+		// Since all the coefficients of C are positive, only the evaluations
+		// at -1 need to keep track of their sign.
+
+		// Split to get the pieces:
+		auto a0 = split_piece(lhs, n, 0);
+		auto a1 = split_piece(lhs, n, 1);
+		auto a2 = split_piece(lhs, n, 2);
+		auto b0 = split_piece(rhs, n, 0);
+		auto b1 = split_piece(rhs, n, 1);
+		auto b2 = split_piece(rhs, n, 2);
+
+		// Evaluate:
+		auto a02 = a0 + a2;
+		uinteger_t pm1(lhs.get_allocator(), true);
+		bool pm1_neg = toom_mult_diff(pm1, a02, a1);
+		auto p1 = a02 + a1;
+		auto p2 = a0 + (a1 << 1) + (a2 << 2);
+
+		auto b02 = b0 + b2;
+		uinteger_t qm1(lhs.get_allocator(), true);
+		bool qm1_neg = toom_mult_diff(qm1, b02, b1);
+		auto q1 = b02 + b1;
+		auto q2 = b0 + (b1 << 1) + (b2 << 2);
 
-		auto it_w = w.begin();
-		auto it_w_e = w.end();
+		// Get the pieces:
+		const auto alloc = lhs.get_allocator();
+		uinteger_t r0(alloc, true), r1(alloc, true), rm1(alloc, true), r2(alloc, true), rinf(alloc, true);
+		toom3_mult(r0, a0, b0, cutoff);
+		toom3_mult(r1, p1, q1, cutoff);
+		toom3_mult(rm1, pm1, qm1, cutoff);
+		toom3_mult(r2, p2, q2, cutoff);
+		toom3_mult(rinf, a2, b2, cutoff);
 
-		auto rit_w = w.rbegin();
-		auto wm1 = *rit_w++;
-		auto wm2 = *rit_w;
+		return toom3_interpolate(result, lhs_sz + rhs_sz, n, r0, r1, rm1, pm1_neg != qm1_neg, r2, rinf);
+	}
 
-		// D2. inner loop: divide v[k+0..k+n] by w[0..n]
-		for (; it_v_k >= it_v_b; --it_v_k, ++rit_q) {
-			// D3. Compute estimate quotient digit q; may overestimate by 1 (rare)
-			digit _q;
-			auto _r = _divmod(*(it_v_k + w_size), *(it_v_k + w_size - 1), wm1, &_q);
-			digit mullo = 0;
-			auto mulhi = _mult(_q, wm2, &mullo);
-			auto rlo = *(it_v_k + w_size - 2);
-			while (mulhi > _r || (mulhi == _r && mullo > rlo)) {
-				--_q;
-				if (_addcarry(_r, wm1, 0, &_r)) {
-					break;
-				}
-				mulhi = _mult(_q, wm2, &mullo);
-			}
+	// Toom-Cook 3-way squaring, same as toom3_mult() but all evaluations are
+	// squared (so the evaluation at -1 is always positive).
+	static uinteger_t& toom3_sqr(uinteger_t& result, const uinteger_t& lhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
 
-			// D4. Multiply and subtract _q * w0[0:size_w] from vk[0:size_w+1]
-			auto _it_v = it_v_k;
-			auto _it_w = it_w;
-			mulhi = 0;
-			digit carry = 0;
-			for (; _it_w != it_w_e; ++_it_v, ++_it_w) {
-				mullo = 0;
-				mulhi = _multadd(*_it_w, _q, 0, mulhi, &mullo);
-				carry = _subborrow(*_it_v, mullo, carry, &*_it_v);
-			}
-			carry = _subborrow(*_it_v, 0, carry, &*_it_v);
+		if (lhs_sz <= cutoff) {
+			return karatsuba_sqr(result, lhs, karatsuba_sqr_cutoff);
+		}
 
-			if (carry) {
-				// D6. Add w back if q was too large (this branch taken rarely)
-				--_q;
+		// Calculate the split point at a third.
+		auto n = (lhs_sz + 2) / 3;
 
-				_it_v = it_v_k;
-				_it_w = it_w;
-				carry = 0;
-				for (; _it_w != it_w_e; ++_it_v, ++_it_w) {
-					carry = _addcarry(*_it_v, *_it_w, carry, &*_it_v);
-				}
-				carry = _addcarry(*_it_v, 0, carry, &*_it_v);
-			}
+		// Split to get the pieces:
+		auto a0 = split_piece(lhs, n, 0);
+		auto a1 = split_piece(lhs, n, 1);
+		auto a2 = split_piece(lhs, n, 2);
 
-			/* store quotient digit */
-			*rit_q = _q;
-		}
+		// Evaluate:
+		auto a02 = a0 + a2;
+		uinteger_t pm1(lhs.get_allocator(), true);
+		toom_mult_diff(pm1, a02, a1);
+		auto p1 = a02 + a1;
+		auto p2 = a0 + (a1 << 1) + (a2 << 2);
 
-		// D8. unnormalize: unshift remainder.
-		v.resize(w_size);
-		v >>= d;
+		// Get the pieces:
+		const auto alloc = lhs.get_allocator();
+		uinteger_t r0(alloc, true), r1(alloc, true), rm1(alloc, true), r2(alloc, true), rinf(alloc, true);
+		toom3_sqr(r0, a0, cutoff);
+		toom3_sqr(r1, p1, cutoff);
+		toom3_sqr(rm1, pm1, cutoff);
+		toom3_sqr(r2, p2, cutoff);
+		toom3_sqr(rinf, a2, cutoff);
 
-		q.trim();
-		v.trim();
+		return toom3_interpolate(result, lhs_sz * 2, n, r0, r1, rm1, false, r2, rinf);
+	}
 
-		quotient = std::move(q);
-		remainder = std::move(v);
-		return std::make_pair(std::ref(quotient), std::ref(remainder));
+	// Toom-Cook 4-way multiplication (Toom-44)
+	static uinteger_t& toom4_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
+
+		if (lhs_sz > rhs_sz) {
+			// rhs should be the largest:
+			return toom4_mult(result, rhs, lhs, cutoff);
+		}
+
+		if (lhs_sz <= cutoff) {
+			return toom3_mult(result, lhs, rhs, toom3_cutoff);
+		}
+
+		// Calculate the split point at a fourth of the largest (rhs).
+		auto n = (rhs_sz + 3) / 4;
+
+		// If lhs is too small compared to rhs, multiply by slices.
+		if (lhs_sz <= 3 * n) {
+			if (lhs_sz == rhs_sz) {
+				// Too small to be split in four
+				return toom3_mult(result, lhs, rhs, toom3_cutoff);
+			}
+			return lopsided_mult(result, lhs, rhs, cutoff, toom4_mult);
+		}
+
+		// Toom-44:
+		//
+		//     A(x) = a3 x^3  +  a2 x^2  +  a1 x  +  a0
+		//     B(x) = b3 x^3  +  b2 x^2  +  b1 x  +  b0
+		//     ----------------------------------------
+		//     C(x) = c6 x^6 + c5 x^5 + c4 x^4 + c3 x^3 + c2 x^2 + c1 x + c0
+		//
+		//  r0   = C(0)          = c0
+		//  r1   = C(1)          =    c0 +    c1 +    c2 +   c3 +    c4 +    c5 +    c6
+		//  rm1  = C(-1)         =    c0 -    c1 +    c2 -   c3 +    c4 -    c5 +    c6
+		//  r2   = C(2)          =    c0 +   2c1 +   4c2 +  8c3 +  16c4 +  32c5 +  64c6
+		//  rm2  = C(-2)         =    c0 -   2c1 +   4c2 -  8c3 +  16c4 -  32c5 +  64c6
+		//  rh   = 64 * C(1/2)   =  64c0 +  32c1 +  16c2 +  8c3 +   4c4 +   2c5 +    c6
+		//  rinf = C(inf)        = c6
+		//
+		// Since all the coefficients of C are positive, only the evaluations
+		// at -1 and -2 need to keep track of their sign.
+
+		// Split to get the pieces:
+		auto a0 = split_piece(lhs, n, 0);
+		auto a1 = split_piece(lhs, n, 1);
+		auto a2 = split_piece(lhs, n, 2);
+		auto a3 = split_piece(lhs, n, 3);
+		auto b0 = split_piece(rhs, n, 0);
+		auto b1 = split_piece(rhs, n, 1);
+		auto b2 = split_piece(rhs, n, 2);
+		auto b3 = split_piece(rhs, n, 3);
+
+		// Evaluate:
+		auto a02 = a0 + a2;
+		auto a13 = a1 + a3;
+		uinteger_t pm1(lhs.get_allocator(), true);
+		bool pm1_neg = toom_mult_diff(pm1, a02, a13);
+		auto p1 = a02 + a13;
+		auto a02_2 = a0 + (a2 << 2);
+		auto a13_2 = (a1 << 1) + (a3 << 3);
+		uinteger_t pm2(lhs.get_allocator(), true);
+		bool pm2_neg = toom_mult_diff(pm2, a02_2, a13_2);
+		auto p2 = a02_2 + a13_2;
+		auto ph = (a0 << 3) + (a1 << 2) + (a2 << 1) + a3;
+
+		auto b02 = b0 + b2;
+		auto b13 = b1 + b3;
+		uinteger_t qm1(lhs.get_allocator(), true);
+		bool qm1_neg = toom_mult_diff(qm1, b02, b13);
+		auto q1 = b02 + b13;
+		auto b02_2 = b0 + (b2 << 2);
+		auto b13_2 = (b1 << 1) + (b3 << 3);
+		uinteger_t qm2(lhs.get_allocator(), true);
+		bool qm2_neg = toom_mult_diff(qm2, b02_2, b13_2);
+		auto q2 = b02_2 + b13_2;
+		auto qh = (b0 << 3) + (b1 << 2) + (b2 << 1) + b3;
+
+		// Get the pieces:
+		const auto alloc = lhs.get_allocator();
+		uinteger_t r0(alloc, true), r1(alloc, true), rm1(alloc, true), r2(alloc, true), rm2(alloc, true), rh(alloc, true), rinf(alloc, true);
+		toom4_mult(r0, a0, b0, cutoff);
+		toom4_mult(r1, p1, q1, cutoff);
+		toom4_mult(rm1, pm1, qm1, cutoff);
+		toom4_mult(r2, p2, q2, cutoff);
+		toom4_mult(rm2, pm2, qm2, cutoff);
+		toom4_mult(rh, ph, qh, cutoff);
+		toom4_mult(rinf, a3, b3, cutoff);
+
+		return toom4_interpolate(result, lhs_sz + rhs_sz, n, r0, r1, rm1, pm1_neg != qm1_neg, r2, rm2, pm2_neg != qm2_neg, rh, rinf);
+	}
+
+	// Toom-Cook 4-way squaring, same as toom4_mult() but all evaluations are
+	// squared (so the evaluations at -1 and -2 are always positive).
+	static uinteger_t& toom4_sqr(uinteger_t& result, const uinteger_t& lhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+
+		if (lhs_sz <= cutoff) {
+			return toom3_sqr(result, lhs, toom3_sqr_cutoff);
+		}
+
+		// Calculate the split point at a fourth.
+		auto n = (lhs_sz + 3) / 4;
+		if (lhs_sz <= 3 * n) {
+			// Too small to be split in four
+			return toom3_sqr(result, lhs, toom3_sqr_cutoff);
+		}
+
+		// Split to get the pieces:
+		auto a0 = split_piece(lhs, n, 0);
+		auto a1 = split_piece(lhs, n, 1);
+		auto a2 = split_piece(lhs, n, 2);
+		auto a3 = split_piece(lhs, n, 3);
+
+		// Evaluate:
+		auto a02 = a0 + a2;
+		auto a13 = a1 + a3;
+		uinteger_t pm1(lhs.get_allocator(), true);
+		toom_mult_diff(pm1, a02, a13);
+		auto p1 = a02 + a13;
+		auto a02_2 = a0 + (a2 << 2);
+		auto a13_2 = (a1 << 1) + (a3 << 3);
+		uinteger_t pm2(lhs.get_allocator(), true);
+		toom_mult_diff(pm2, a02_2, a13_2);
+		auto p2 = a02_2 + a13_2;
+		auto ph = (a0 << 3) + (a1 << 2) + (a2 << 1) + a3;
+
+		// Get the pieces:
+		const auto alloc = lhs.get_allocator();
+		uinteger_t r0(alloc, true), r1(alloc, true), rm1(alloc, true), r2(alloc, true), rm2(alloc, true), rh(alloc, true), rinf(alloc, true);
+		toom4_sqr(r0, a0, cutoff);
+		toom4_sqr(r1, p1, cutoff);
+		toom4_sqr(rm1, pm1, cutoff);
+		toom4_sqr(r2, p2, cutoff);
+		toom4_sqr(rm2, pm2, cutoff);
+		toom4_sqr(rh, ph, cutoff);
+		toom4_sqr(rinf, a3, cutoff);
+
+		return toom4_interpolate(result, lhs_sz * 2, n, r0, r1, rm1, false, r2, rm2, false, rh, rinf);
+	}
+
+	// A helper for NTT multiplication, one of the primes used for the transforms.
+	struct ntt_prime {
+		digit p;         // prime, of the form k * 2^e + 1
+		digit g;         // primitive root modulo p
+		std::size_t e;   // transforms can be up to 2^e digits long
+		digit pinv;      // -p^-1 modulo digit base (for Montgomery reduction)
+		digit r2;        // digit base^2 modulo p (to convert into Montgomery form)
+	};
+
+	static ntt_prime ntt_prime_init(digit p, digit g, std::size_t e) {
+		auto pinv = _inverse(p);
+
+		digit r = static_cast<digit>(0 - p) % p;
+		digit lo, r2;
+		auto hi = _mult(r, r, &lo);
+		r2 = _divmod(hi, lo, p, &lo);
+
+		return {p, g, e, static_cast<digit>(0 - pinv), r2};
 	}
 
-	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
-		// First try saving some calculations:
-		if (!rhs) {
-			throw std::domain_error("Error: division or modulus by 0");
+	// The product of the three primes is big enough to hold each digit of the
+	// convolution of numbers of up to 2^55 digits, so the result can be
+	// recombined from the three transforms using the Chinese Remainder Theorem.
+	static const ntt_prime* ntt_primes() {
+		static const ntt_prime primes[3] = {
+			ntt_prime_init(0x3a00000000000001ULL, 3, 57),  // 29 * 2^57 + 1
+			ntt_prime_init(0x2280000000000001ULL, 5, 55),  // 69 * 2^55 + 1
+			ntt_prime_init(0x1b00000000000001ULL, 5, 56),  // 27 * 2^56 + 1
+		};
+		return primes;
+	}
+
+	// Montgomery multiplication modulo the prime, (x * y) / digit base
+	// Inputs must be such that x * y < p * digit base.
+	static digit ntt_mulmod(digit x, digit y, const ntt_prime& prime) {
+		digit lo;
+		auto hi = _mult(x, y, &lo);
+		digit m = lo * prime.pinv;
+		digit mlo;
+		auto mhi = _mult(m, prime.p, &mlo);
+		// lo + mlo is always zero (mod digit base), it carries unless lo is zero
+		auto t = hi + mhi + (lo != 0);
+		return t >= prime.p ? t - prime.p : t;
+	}
+
+	static digit ntt_powmod(digit x, digit n, const ntt_prime& prime) {
+		auto r = ntt_mulmod(1, prime.r2, prime);
+		for (; n; n >>= 1) {
+			if (n & 1) {
+				r = ntt_mulmod(r, x, prime);
+			}
+			x = ntt_mulmod(x, x, prime);
+		}
+		return r;
+	}
+
+	// Builds the table of roots used by the transforms, roots[len + j] = w^(j * n / 2len)
+	// where w is a primitive n-th root of unity (in Montgomery form).
+	static void ntt_roots(std::vector<digit>& roots, std::size_t n, digit w, const ntt_prime& prime) {
+		roots.resize(n);
+		auto half = n >> 1;
+		auto x = ntt_mulmod(1, prime.r2, prime);
+		for (std::size_t j = 0; j < half; ++j) {
+			roots[half + j] = x;
+			x = ntt_mulmod(x, w, prime);
+		}
+		for (auto len = half >> 1; len; len >>= 1) {
+			for (std::size_t j = 0; j < len; ++j) {
+				roots[len + j] = roots[(len + j) << 1];
+			}
+		}
+	}
+
+	// Forward transform (decimation in frequency), leaves values in bit-reversed order.
+	static void ntt_forward(digit* a, std::size_t n, const digit* roots, const ntt_prime& prime) {
+		auto p = prime.p;
+		for (auto len = n >> 1; len; len >>= 1) {
+			auto w = roots + len;
+			for (std::size_t i = 0; i < n; i += len << 1) {
+				auto x = a + i;
+				auto y = x + len;
+				for (std::size_t j = 0; j < len; ++j) {
+					auto u = x[j];
+					auto v = y[j];
+					auto s = u + v;
+					x[j] = s >= p ? s - p : s;
+					y[j] = ntt_mulmod(u >= v ? u - v : u + p - v, w[j], prime);
+				}
+			}
+		}
+	}
+
+	// Inverse transform (decimation in time), takes values in bit-reversed order.
+	static void ntt_inverse(digit* a, std::size_t n, const digit* roots, const ntt_prime& prime) {
+		auto p = prime.p;
+		for (std::size_t len = 1; len < n; len <<= 1) {
+			auto w = roots + len;
+			for (std::size_t i = 0; i < n; i += len << 1) {
+				auto x = a + i;
+				auto y = x + len;
+				for (std::size_t j = 0; j < len; ++j) {
+					auto u = x[j];
+					auto v = ntt_mulmod(y[j], w[j], prime);
+					auto s = u + v;
+					x[j] = s >= p ? s - p : s;
+					y[j] = u >= v ? u - v : u + p - v;
+				}
+			}
+		}
+	}
+
+	// Cyclic convolution of the digits of lhs and rhs modulo the prime,
+	// values are left in standard form (not in Montgomery form).
+	static void ntt_convolution(std::vector<digit>& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t n, const ntt_prime& prime) {
+		assert(((n - 1) >> prime.e) == 0);
+
+		// Primitive n-th root of unity and its inverse:
+		auto w = ntt_powmod(ntt_mulmod(prime.g, prime.r2, prime), (prime.p - 1) / n, prime);
+		auto w_inv = ntt_powmod(w, n - 1, prime);
+
+		std::vector<digit> roots;
+
+		// Transform into Montgomery form:
+		result.assign(n, 0);
+		std::transform(lhs.begin(), lhs.end(), result.begin(), [&prime](digit x) { return ntt_mulmod(x, prime.r2, prime); });
+		ntt_roots(roots, n, w, prime);
+		ntt_forward(result.data(), n, roots.data(), prime);
+
+		// Pointwise multiplication:
+		if (&lhs == &rhs) {
+			// Squaring only needs one transform
+			for (auto& x : result) {
+				x = ntt_mulmod(x, x, prime);
+			}
+		} else {
+			std::vector<digit> tmp(n, 0);
+			std::transform(rhs.begin(), rhs.end(), tmp.begin(), [&prime](digit x) { return ntt_mulmod(x, prime.r2, prime); });
+			ntt_forward(tmp.data(), n, roots.data(), prime);
+			for (std::size_t i = 0; i < n; ++i) {
+				result[i] = ntt_mulmod(result[i], tmp[i], prime);
+			}
+		}
+
+		ntt_roots(roots, n, w_inv, prime);
+		ntt_inverse(result.data(), n, roots.data(), prime);
+
+		// Scale by n^-1 which also takes values out of Montgomery form:
+		auto n_inv = prime.p - (prime.p - 1) / n;
+		for (auto& x : result) {
+			x = ntt_mulmod(x, n_inv, prime);
 		}
+	}
+
+	// Number Theoretic Transform multiplication
+	// Uses three NTT primes below 2^62 and recombines the convolutions using
+	// Garner's algorithm, numbers can be up to 2^55 digits long.
+	static uinteger_t& ntt_mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, std::size_t cutoff = 1) {
 		auto lhs_sz = lhs.size();
 		auto rhs_sz = rhs.size();
-		if (lhs_sz == 1 && rhs_sz == 1) {
-			// Fast division and modulo for single value
-			auto a = *lhs.begin();
-			auto b = *rhs.begin();
-			quotient = a / b;
-			remainder = a % b;
-			return std::make_pair(std::ref(quotient), std::ref(remainder));
+
+		if (lhs_sz > rhs_sz) {
+			// rhs should be the largest:
+			return ntt_mult(result, rhs, lhs, cutoff);
+		}
+
+		if (lhs_sz <= cutoff || digit_bits != 64) {
+			return toom4_mult(result, lhs, rhs, toom4_cutoff);
+		}
+
+		auto result_sz = lhs_sz + rhs_sz;
+		std::size_t n = 1;
+		while (n < result_sz - 1) {
+			n <<= 1;
+		}
+
+		const auto primes = ntt_primes();
+		const auto& p1 = primes[0];
+		const auto& p2 = primes[1];
+		const auto& p3 = primes[2];
+
+		std::vector<digit> x1, x2, x3;
+		ntt_convolution(x1, lhs, rhs, n, p1);
+		ntt_convolution(x2, lhs, rhs, n, p2);
+		ntt_convolution(x3, lhs, rhs, n, p3);
+
+		// Garner's algorithm constants (in Montgomery form):
+		auto p1_inv_2 = ntt_powmod(ntt_mulmod(p1.p, p2.r2, p2), p2.p - 2, p2);  // p1^-1 mod p2
+		auto p1_3 = ntt_mulmod(p1.p, p3.r2, p3);  // p1 mod p3
+		auto p1p2_3 = ntt_mulmod(p1_3, ntt_mulmod(p2.p, p3.r2, p3), p3);  // p1 * p2 mod p3
+		auto p1p2_inv_3 = ntt_powmod(p1p2_3, p3.p - 2, p3);  // (p1 * p2)^-1 mod p3
+		auto one_3 = ntt_mulmod(1, p3.r2, p3);
+
+		uinteger_t r(lhs.get_allocator(), result._value.scratch());
+		r.resize(result_sz, 0);
+
+		auto it = r.begin();
+		auto it_e = r.end();
+
+		digit acc0 = 0, acc1 = 0, acc2 = 0;
+		for (std::size_t i = 0; i < result_sz - 1; ++i, ++it) {
+			// x = v1 + v2 * p1 + v3 * p1 * p2
+			auto v1 = x1[i];
+			auto v1_2 = v1 >= p2.p ? v1 - p2.p : v1;
+			auto v2 = ntt_mulmod(x2[i] >= v1_2 ? x2[i] - v1_2 : x2[i] + p2.p - v1_2, p1_inv_2, p2);
+			auto v12_3 = ntt_mulmod(v1, one_3, p3) + ntt_mulmod(v2, p1_3, p3);
+			v12_3 = v12_3 >= p3.p ? v12_3 - p3.p : v12_3;
+			auto v3 = ntt_mulmod(x3[i] >= v12_3 ? x3[i] - v12_3 : x3[i] + p3.p - v12_3, p1p2_inv_3, p3);
+
+			digit t_lo, x_0, x_1;
+			auto t_hi = _multadd(v3, p2.p, v2, 0, &t_lo);
+			auto carry = _multadd(t_lo, p1.p, v1, 0, &x_0);
+			auto x_2 = _multadd(t_hi, p1.p, carry, 0, &x_1);
+
+			// Add to the accumulated carry and store the lowest digit:
+			carry = _addcarry(acc0, x_0, 0, &acc0);
+			carry = _addcarry(acc1, x_1, carry, &acc1);
+			_addcarry(acc2, x_2, carry, &acc2);
+			*it = acc0;
+			acc0 = acc1;
+			acc1 = acc2;
+			acc2 = 0;
+		}
+		for (; it != it_e; ++it) {
+			*it = acc0;
+			acc0 = acc1;
+			acc1 = 0;
+		}
+
+		result = std::move(r);
+
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	// Number Theoretic Transform squaring
+	static uinteger_t& ntt_sqr(uinteger_t& result, const uinteger_t& lhs, std::size_t cutoff = 1) {
+		auto lhs_sz = lhs.size();
+
+		if (lhs_sz <= cutoff || digit_bits != 64) {
+			return toom4_sqr(result, lhs, toom4_sqr_cutoff);
+		}
+
+		return ntt_mult(result, lhs, lhs, 0);
+	}
+
+	static uinteger_t& mult(uinteger_t& lhs, const uinteger_t& rhs) {
+		// Hard to see how this could have a further optimized implementation.
+		return mult(lhs, lhs, rhs);
+	}
+
+	static uinteger_t& mult(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		// First try saving some calculations:
+		if (!lhs || !rhs) {
+			result = uint_0();
+			return result;
+		}
+		if (compare(lhs, uint_1()) == 0) {
+			result = rhs;
+			return result;
 		}
 		if (compare(rhs, uint_1()) == 0) {
-			quotient = lhs;
-			remainder = uint_0();
-			return std::make_pair(std::ref(quotient), std::ref(remainder));
+			result = lhs;
+			return result;
 		}
-		auto compared = compare(lhs, rhs);
-		if (compared == 0) {
-			quotient = uint_1();
-			remainder = uint_0();
-			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		if (&lhs == &rhs) {
+			return sqr(result, lhs);
 		}
-		if (!lhs || compared < 0) {
-			quotient = uint_0();
-			remainder = lhs;
-			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		// Equal values square too, but comparing them takes a full scan when
+		// they share their top digits (like numbers reduced by a modulus do),
+		// which only pays off when squaring saves more than that:
+		auto lhs_sz = lhs.size();
+		if (lhs_sz == rhs.size() && lhs_sz > karatsuba_cutoff && compare(lhs, rhs) == 0) {
+			return sqr(result, lhs);
 		}
-		if (rhs_sz == 1) {
-			return single_divmod(quotient, remainder, lhs, rhs);
+
+		return ntt_mult(result, lhs, rhs, ntt_cutoff);
+	}
+
+	static uinteger_t mult(const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t result(lhs.get_allocator());
+		mult(result, lhs, rhs);
+		return result;
+	}
+
+	static uinteger_t& sqr(uinteger_t& lhs) {
+		return sqr(lhs, lhs);
+	}
+
+	static uinteger_t& sqr(uinteger_t& result, const uinteger_t& lhs) {
+		// First try saving some calculations:
+		if (!lhs) {
+			result = uint_0();
+			return result;
+		}
+		if (compare(lhs, uint_1()) == 0) {
+			result = lhs;
+			return result;
 		}
 
-		return knuth_divmod(quotient, remainder, lhs, rhs);
+		return ntt_sqr(result, lhs, ntt_sqr_cutoff);
 	}
 
-	static std::pair<uinteger_t, uinteger_t> divmod(const uinteger_t& lhs, const uinteger_t& rhs) {
-		uinteger_t quotient;
-		uinteger_t remainder;
-		divmod(quotient, remainder, lhs, rhs);
-		return std::make_pair(std::move(quotient), std::move(remainder));
+	static uinteger_t sqr(const uinteger_t& lhs) {
+		uinteger_t result(lhs.get_allocator());
+		sqr(result, lhs);
+		return result;
+	}
+
+	// Integer power, by left to right binary exponentiation: squares, and
+	// multiplies by base (which stays small) for each one bit of exp.
+	// Factors of two are taken out of base and shifted back in at the end,
+	// so powers of two are a single shift.
+	static uinteger_t& pow(uinteger_t& result, const uinteger_t& base, std::size_t exp) {
+		// First try saving some calculations:
+		if (!exp) {
+			result = uint_1();
+			return result;
+		}
+		if (!base) {
+			result = uint_0();
+			return result;
+		}
+
+		// base = odd * 2^shift
+		std::size_t shift = 0;
+		auto it = base.begin();
+		for (; !*it; ++it) {
+			shift += digit_bits;
+		}
+		for (auto d = *it; !(d & 1); d >>= 1) {
+			++shift;
+		}
+		auto odd = base >> shift;
+		shift *= exp;
+
+		uinteger_t acc(odd);
+		uinteger_t tmp(base.get_allocator());
+		if (compare(odd, uint_1()) != 0) {
+			std::size_t i = 0;
+			while (exp >> i) {
+				++i;
+			}
+			for (--i; i--;) {
+				sqr(tmp, acc);
+				std::swap(acc, tmp);
+				if ((exp >> i) & 1) {
+					mult(tmp, acc, odd);
+					std::swap(acc, tmp);
+				}
+			}
+		}
+
+		// The size of the result is known, so it's reserved once
+		// before shifting the factors of two back in:
+		auto sz = acc.size() + (shift + digit_bits - 1) / digit_bits;
+		result.clear();
+		result.reserve(sz);
+		result.append(shift / digit_bits, 0);
+		result.append(acc << (shift % digit_bits));
+		return result;
+	}
+
+	static uinteger_t pow(const uinteger_t& base, std::size_t exp) {
+		uinteger_t result(base.get_allocator());
+		pow(result, base, exp);
+		return result;
+	}
+
+	// Single word long division by a divisor (using its reciprocal),
+	// returns the remainder. The quotient can be lhs itself.
+	static digit divmod(uinteger_t& quotient, const uinteger_t& lhs, const divisor& rhs) {
+		auto lhs_sz = lhs.size();
+		auto in_place = &quotient == &lhs;
+
+		uinteger_t q(lhs.get_allocator());
+		if (!in_place) {
+			q.resize(lhs_sz);
+		}
+		auto& result = in_place ? quotient : q;
+		auto x = lhs.data();
+		auto y = result.data();
+
+		digit r = 0;
+		for (auto i = lhs_sz; i--;) {
+			r = rhs.divmod(r, x[i], &y[i]);
+		}
+		result.trim();
+
+		if (!in_place) {
+			quotient = std::move(q);
+		}
+		return r;
+	}
+
+	// Remainder by a divisor (using its reciprocal)
+	static digit mod(const uinteger_t& lhs, const divisor& rhs) {
+		digit r = 0;
+		for (auto it = lhs.rbegin(); it != lhs.rend(); ++it) {
+			r = rhs.mod(r, *it);
+		}
+		return r;
+	}
+
+	// Single word long division
+	// Fastests, but ONLY for single sized rhs
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> single_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+		assert(rhs.size() == 1);
+		auto r = divmod(quotient, lhs, divisor(rhs.front()));
+		remainder = r;
+		return std::make_pair(std::ref(quotient), std::ref(remainder));
+	}
+
+	// Remainders of lhs by many single digit divisors, scanning the digits of
+	// lhs once (for every 16 divisors), with their reciprocals instead of
+	// dividing, and without allocating.
+	static void mod_small(const uinteger_t& lhs, const digit* divisors, std::size_t count, digit* remainders) {
+		constexpr std::size_t chunk = 16;
+		divisor d[chunk];
+		for (std::size_t i = 0; i < count; i += chunk) {
+			auto n = std::min(chunk, count - i);
+			auto r = remainders + i;
+			for (std::size_t j = 0; j < n; ++j) {
+				d[j] = divisor(divisors[i + j]);
+				r[j] = 0;
+			}
+			for (auto it = lhs.rbegin(); it != lhs.rend(); ++it) {
+				auto x = *it;
+				for (std::size_t j = 0; j < n; ++j) {
+					r[j] = d[j].mod(r[j], x);
+				}
+			}
+		}
+	}
+
+	// Implementation of Knuth's Algorithm D
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> knuth_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t v(lhs.get_allocator(), true), w(lhs.get_allocator(), true);
+		v = lhs;
+		w = rhs;
+
+		auto v_size = v.size();
+		auto w_size = w.size();
+		assert(v_size >= w_size && w_size >= 2);
+
+		// D1. normalize: shift rhs left so that its top digit is >= 63 bits.
+		// shift lhs left by the same amount. Results go into w and v.
+		auto d = uinteger_t(digit_bits - _bits(w.back()));
+		v <<= d;
+		w <<= d;
+
+		if (*v.rbegin() >= *w.rbegin()) {
+			v.append(0);
+		}
+		v_size = v.size();
+		v.append(0);
+
+		// Now *v.rbegin() < *w.rbegin() so quotient has at most
+		// (and usually exactly) k = v.size() - w.size() digits.
+		auto k = v_size - w_size;
+		uinteger_t q(lhs.get_allocator());
+		q.resize(k + 1, 0);
+
+		auto rit_q = q.rend() - (k + 1);
+
+		auto it_v_b = v.begin();
+		auto it_v_k = it_v_b + k;
+
+		auto it_w = w.begin();
+		auto it_w_e = w.end();
+
+		auto rit_w = w.rbegin();
+		auto wm1 = *rit_w++;
+		auto wm2 = *rit_w;
+
+		// D2. inner loop: divide v[k+0..k+n] by w[0..n]
+		for (; it_v_k >= it_v_b; --it_v_k, ++rit_q) {
+			// D3. Compute estimate quotient digit q; may overestimate by 1 (rare)
+			digit _q;
+			digit _r;
+			bool r_overflow = false;
+			if (*(it_v_k + w_size) == wm1) {
+				// The quotient digit would overflow, start with the maximum digit:
+				_q = std::numeric_limits<digit>::max();
+				r_overflow = _addcarry(*(it_v_k + w_size - 1), wm1, 0, &_r);
+			} else {
+				_r = _divmod(*(it_v_k + w_size), *(it_v_k + w_size - 1), wm1, &_q);
+			}
+			digit mullo = 0;
+			auto mulhi = _mult(_q, wm2, &mullo);
+			auto rlo = *(it_v_k + w_size - 2);
+			while (!r_overflow && (mulhi > _r || (mulhi == _r && mullo > rlo))) {
+				--_q;
+				if (_addcarry(_r, wm1, 0, &_r)) {
+					break;
+				}
+				mulhi = _mult(_q, wm2, &mullo);
+			}
+
+			// D4. Multiply and subtract _q * w0[0:size_w] from vk[0:size_w+1]
+			auto _it_v = it_v_k;
+			auto _it_w = it_w;
+			mulhi = 0;
+			digit carry = 0;
+			for (; _it_w != it_w_e; ++_it_v, ++_it_w) {
+				mullo = 0;
+				mulhi = _multadd(*_it_w, _q, 0, mulhi, &mullo);
+				carry = _subborrow(*_it_v, mullo, carry, &*_it_v);
+			}
+			carry = _subborrow(*_it_v, mulhi, carry, &*_it_v);
+
+			if (carry) {
+				// D6. Add w back if q was too large (this branch taken rarely)
+				--_q;
+
+				_it_v = it_v_k;
+				_it_w = it_w;
+				carry = 0;
+				for (; _it_w != it_w_e; ++_it_v, ++_it_w) {
+					carry = _addcarry(*_it_v, *_it_w, carry, &*_it_v);
+				}
+				carry = _addcarry(*_it_v, 0, carry, &*_it_v);
+			}
+
+			/* store quotient digit */
+			*rit_q = _q;
+		}
+
+		// D8. unnormalize: unshift remainder.
+		v.resize(w_size);
+		v >>= d;
+
+		q.trim();
+		v.trim();
+
+		quotient = std::move(q);
+		remainder = std::move(v);
+		return std::make_pair(std::ref(quotient), std::ref(remainder));
+	}
+
+	// Burnikel-Ziegler recursive division
+	//
+	// Based on "Fast Recursive Division" by Christoph Burnikel and Joachim Ziegler,
+	// lhs is seen as a sequence of digits in base B^n (n being the size of rhs)
+	// and divided by rhs one such digit at a time (just as in long division),
+	// each step divides a 2n digits number by an n digits number, recursively
+	// splitting it in two divisions of 3 halves by 2 halves.
+
+	// Divides a (less than b * B^n) by b (of n digits, normalized)
+	static void burnikel_ziegler_div2n1n(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& a, const uinteger_t& b, std::size_t n) {
+		if (n <= burnikel_ziegler_cutoff) {
+			divmod(quotient, remainder, a, b);
+			return;
+		}
+
+		// n is always even here, as it was padded to j * 2^k (j <= cutoff)
+		assert(!(n & 1));
+		auto half_n = n >> 1;
+
+		// Split to get b1 and b2:
+		auto b1 = split_piece(b, half_n, 1);
+		auto b2 = split_piece(b, half_n, 0);
+
+		// Split to get [a1 a2] a3 a4:
+		auto a12 = a >> (n * digit_bits);
+		auto a3 = split_piece(a, half_n, 1);
+		auto a4 = split_piece(a, half_n, 0);
+
+		const auto alloc = a.get_allocator();
+		uinteger_t q1(alloc), q2(alloc), r(alloc);
+		burnikel_ziegler_div3n2n(q1, r, a12, a3, b, b1, b2, half_n);
+		burnikel_ziegler_div3n2n(q2, remainder, r, a4, b, b1, b2, half_n);
+
+		quotient = std::move(q1);
+		quotient <<= half_n * digit_bits;
+		quotient += q2;
+	}
+
+	// Divides [a12 a3] (less than b * B^n) by [b1 b2] (b, of 2n digits, normalized)
+	static void burnikel_ziegler_div3n2n(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& a12, const uinteger_t& a3, const uinteger_t& b, const uinteger_t& b1, const uinteger_t& b2, std::size_t n) {
+		uinteger_t q(a12.get_allocator()), r(a12.get_allocator());
+		if (compare(a12 >> (n * digit_bits), b1) == 0) {
+			// The quotient would be B^n (too big), use B^n - 1 instead:
+			q = (uint_1(a12.get_allocator()) << (n * digit_bits)) - uint_1();
+			r = a12 - (b1 << (n * digit_bits)) + b1;
+		} else {
+			burnikel_ziegler_div2n1n(q, r, a12, b1, n);
+		}
+
+		// [r a3] - q * b2 might be negative, in which case q is too big
+		// (by at most 2) and b needs to be added back:
+		r <<= n * digit_bits;
+		r += a3;
+		auto d = q * b2;
+		while (compare(r, d) < 0) {
+			--q;
+			r += b;
+		}
+		r -= d;
+
+		quotient = std::move(q);
+		remainder = std::move(r);
+	}
+
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> burnikel_ziegler_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+		// Pad the size of rhs to n = j * 2^k, with j <= cutoff, so that
+		// it can be halved all the way down to the base case:
+		auto rhs_sz = rhs.size();
+		std::size_t k = 0;
+		while (((rhs_sz - 1) >> k) + 1 > burnikel_ziegler_cutoff) {
+			++k;
+		}
+		auto n = (((rhs_sz - 1) >> k) + 1) << k;
+
+		// Normalize: shift rhs left so that its top digit has the highest bit set
+		// (and it gets n digits), shift lhs left by the same amount.
+		auto d = (n - rhs_sz) * digit_bits + digit_bits - _bits(rhs.back());
+		auto a = lhs << d;
+		auto b = rhs << d;
+
+		auto a_sz = a.size();
+
+		// Long division, in base B^n:
+		auto i = (a_sz + n - 1) / n;
+		uinteger_t q(lhs.get_allocator()), r(lhs.get_allocator());
+		q.resize(i * n, 0);
+		while (i--) {
+			r <<= n * digit_bits;
+			r += split_piece(a, n, i);
+			uinteger_t qi(lhs.get_allocator());
+			burnikel_ziegler_div2n1n(qi, r, uinteger_t(r), b, n);
+			std::copy(qi.begin(), qi.end(), q.begin() + i * n);
+		}
+
+		// Unnormalize: unshift remainder.
+		r >>= d;
+
+		q.trim();
+
+		quotient = std::move(q);
+		remainder = std::move(r);
+		return std::make_pair(std::ref(quotient), std::ref(remainder));
+	}
+
+	// Newton reciprocal
+	//
+	// Computes floor(2^(2 * bits) / rhs), for rhs of exactly bits bits, by
+	// Newton iteration: x = x + x * (2^(2 * bits) - rhs * x) / 2^(2 * bits),
+	// starting from the reciprocal of the top half of rhs so that each level
+	// doubles the precision (thus only the top half of the error is needed).
+	// Inner levels can be a few units off, the result is fixed up at the end.
+	static uinteger_t& newton_reciprocal(uinteger_t& result, const uinteger_t& rhs, std::size_t bits, bool exact = true) {
+		if (bits <= newton_reciprocal_cutoff * digit_bits) {
+			uinteger_t remainder(rhs.get_allocator());
+			divmod(result, remainder, uint_1(rhs.get_allocator()) << (2 * bits), rhs);
+			return result;
+		}
+
+		// Reciprocal of the top half of rhs (plus some guard bits), which
+		// is the reciprocal of rhs scaled down by 2^shift:
+		auto half_bits = (bits >> 1) + 3;
+		auto shift = bits - half_bits;
+		uinteger_t x(rhs.get_allocator());
+		newton_reciprocal(x, rhs >> shift, half_bits, false);
+
+		// Newton step, the error (also scaled down by 2^shift) is truncated
+		// to the bits that matter:
+		auto t = rhs * x;
+		auto one = uint_1(rhs.get_allocator()) << (bits + half_bits);
+		auto guard = half_bits - 5;
+		auto negative = compare(t, one) > 0;
+		auto e = negative ? t - one : one - t;
+		auto delta = (x * (e >> guard)) >> (2 * half_bits - guard);
+		x <<= shift;
+		if (negative) {
+			x -= delta;
+		} else {
+			x += delta;
+		}
+		if (!exact) {
+			result = std::move(x);
+			return result;
+		}
+
+		// Fix up:
+		t = rhs * x;
+		one <<= shift;
+		while (compare(t, one) > 0) {
+			--x;
+			t -= rhs;
+		}
+		one -= t;
+		while (compare(one, rhs) >= 0) {
+			++x;
+			one -= rhs;
+		}
+
+		result = std::move(x);
+		return result;
+	}
+
+	// Normalizes rhs and gets its reciprocal, as used by newton_divmod()
+	static uinteger_t& newton_reciprocal(uinteger_t& result, const uinteger_t& rhs) {
+		auto d = digit_bits - _bits(rhs.back());
+		return newton_reciprocal(result, rhs << d, rhs.size() * digit_bits);
+	}
+
+	// Newton division
+	//
+	// Long division in base B^n (n being the size of rhs), where each step is
+	// a Barrett reduction using the reciprocal of the normalized rhs, so it
+	// costs two multiplications. The reciprocal can be reused.
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> newton_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs, const uinteger_t& reciprocal) {
+		// Normalize: shift rhs left so that its top digit has the highest bit set,
+		// shift lhs left by the same amount.
+		auto d = digit_bits - _bits(rhs.back());
+		auto a = lhs << d;
+		auto b = rhs << d;
+
+		auto n = b.size();
+		auto bits = n * digit_bits;
+		auto a_sz = a.size();
+
+		auto i = (a_sz + n - 1) / n;
+		uinteger_t q(lhs.get_allocator()), r(lhs.get_allocator());
+		q.resize(i * n, 0);
+		while (i--) {
+			r <<= bits;
+			r += split_piece(a, n, i);
+
+			// Estimate is at most 2 short:
+			auto qi = ((r >> (bits - 1)) * reciprocal) >> (bits + 1);
+			r -= qi * b;
+			while (compare(r, b) >= 0) {
+				r -= b;
+				++qi;
+			}
+			std::copy(qi.begin(), qi.end(), q.begin() + i * n);
+		}
+
+		// Unnormalize: unshift remainder.
+		r >>= d;
+
+		q.trim();
+
+		quotient = std::move(q);
+		remainder = std::move(r);
+		return std::make_pair(std::ref(quotient), std::ref(remainder));
+	}
+
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> newton_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t reciprocal(lhs.get_allocator());
+		newton_reciprocal(reciprocal, rhs);
+		return newton_divmod(quotient, remainder, lhs, rhs, reciprocal);
+	}
+
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs) {
+		// First try saving some calculations:
+		if (!rhs) {
+			throw std::domain_error("Error: division or modulus by 0");
+		}
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
+		if (lhs_sz == 1 && rhs_sz == 1) {
+			// Fast division and modulo for single value
+			auto a = *lhs.begin();
+			auto b = *rhs.begin();
+			quotient = a / b;
+			remainder = a % b;
+			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		}
+		if (compare(rhs, uint_1()) == 0) {
+			quotient = lhs;
+			remainder = uint_0();
+			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		}
+		auto compared = compare(lhs, rhs);
+		if (compared == 0) {
+			quotient = uint_1();
+			remainder = uint_0();
+			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		}
+		if (!lhs || compared < 0) {
+			quotient = uint_0();
+			remainder = lhs;
+			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		}
+		if (rhs_sz == 1) {
+			return single_divmod(quotient, remainder, lhs, rhs);
+		}
+		if (rhs_sz > newton_cutoff && lhs_sz - rhs_sz > newton_cutoff) {
+			return newton_divmod(quotient, remainder, lhs, rhs);
+		}
+		if (rhs_sz > burnikel_ziegler_cutoff && lhs_sz - rhs_sz > burnikel_ziegler_cutoff) {
+			return burnikel_ziegler_divmod(quotient, remainder, lhs, rhs);
+		}
+
+		return knuth_divmod(quotient, remainder, lhs, rhs);
+	}
+
+	static std::pair<uinteger_t, uinteger_t> divmod(const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t quotient(lhs.get_allocator());
+		uinteger_t remainder(lhs.get_allocator());
+		divmod(quotient, remainder, lhs, rhs);
+		return std::make_pair(std::move(quotient), std::move(remainder));
+	}
+
+	static uinteger_t& reciprocal(uinteger_t& result, const uinteger_t& rhs) {
+		if (!rhs) {
+			throw std::domain_error("Error: division or modulus by 0");
+		}
+		return newton_reciprocal(result, rhs);
+	}
+
+	static uinteger_t reciprocal(const uinteger_t& rhs) {
+		uinteger_t result(rhs.get_allocator());
+		reciprocal(result, rhs);
+		return result;
+	}
+
+	// Division using a reciprocal of rhs (from reciprocal())
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> reciprocal_divmod(uinteger_t& quotient, uinteger_t& remainder, const uinteger_t& lhs, const uinteger_t& rhs, const uinteger_t& reciprocal) {
+		if (!rhs) {
+			throw std::domain_error("Error: division or modulus by 0");
+		}
+		if (compare(lhs, rhs) < 0) {
+			quotient = uint_0();
+			remainder = lhs;
+			return std::make_pair(std::ref(quotient), std::ref(remainder));
+		}
+
+		return newton_divmod(quotient, remainder, lhs, rhs, reciprocal);
+	}
+
+	static std::pair<uinteger_t, uinteger_t> reciprocal_divmod(const uinteger_t& lhs, const uinteger_t& rhs, const uinteger_t& reciprocal) {
+		uinteger_t quotient(lhs.get_allocator());
+		uinteger_t remainder(lhs.get_allocator());
+		reciprocal_divmod(quotient, remainder, lhs, rhs, reciprocal);
+		return std::make_pair(std::move(quotient), std::move(remainder));
+	}
+
+	// Sliding window exponentiation (for exp > 0), using the given multiplication
+	// and squaring. The odd powers of base are precalculated, up to 2^k, so each
+	// window of up to k bits (starting and ending with a one) takes a single
+	// multiplication, apart from the squarings.
+	template <typename Mult, typename Sqr>
+	static uinteger_t& sliding_window_pow(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp, Mult&& mult, Sqr&& sqr) {
+		auto bits = exp.bits();
+		assert(bits);
+		std::size_t k = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 6 ? 2 : 1;
+
+		auto e = exp.data();
+		auto bit = [e](std::size_t i) -> digit {
+			return (e[i / digit_bits] >> (i % digit_bits)) & 1;
+		};
+
+		// Odd powers: base, base^3, base^5...
+		std::vector<uinteger_t> powers(std::size_t(1) << (k - 1), uinteger_t(base.get_allocator()));
+		powers[0] = base;
+		if (powers.size() > 1) {
+			uinteger_t base2(base.get_allocator());
+			sqr(base2, base);
+			for (std::size_t i = 1; i < powers.size(); ++i) {
+				mult(powers[i], powers[i - 1], base2);
+			}
+		}
+
+		// Squarings and multiplications ping-pong between two numbers,
+		// so their space gets reused:
+		uinteger_t acc(base.get_allocator());
+		uinteger_t tmp(base.get_allocator());
+		bool first = true;
+		for (auto i = bits; i;) {
+			if (!bit(i - 1)) {
+				sqr(tmp, acc);
+				std::swap(acc, tmp);
+				--i;
+				continue;
+			}
+
+			// Window [j, i), the longest one of up to k bits that ends in a one:
+			auto j = i > k ? i - k : 0;
+			while (!bit(j)) {
+				++j;
+			}
+			digit w = 0;
+			for (auto l = i; l-- > j;) {
+				w = (w << 1) | bit(l);
+			}
+
+			if (first) {
+				acc = powers[w >> 1];
+				first = false;
+			} else {
+				for (auto l = j; l < i; ++l) {
+					sqr(tmp, acc);
+					std::swap(acc, tmp);
+				}
+				mult(tmp, acc, powers[w >> 1]);
+				std::swap(acc, tmp);
+			}
+			i = j;
+		}
+
+		result = std::move(acc);
+		return result;
+	}
+
+	// Modular exponentiation, uses Montgomery multiplication for odd moduli
+	// and Barrett reduction for even ones (defined after the contexts).
+	static uinteger_t& powmod(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod);
+
+	static uinteger_t powmod(const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod) {
+		uinteger_t result(base.get_allocator());
+		powmod(result, base, exp, mod);
+		return result;
+	}
+
+	// Constant time modular exponentiation, for odd moduli only.
+	static uinteger_t& powmod_sec(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod);
+
+	static uinteger_t powmod_sec(const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod) {
+		uinteger_t result(base.get_allocator());
+		powmod_sec(result, base, exp, mod);
+		return result;
+	}
+
+	// Greatest common divisor
+	//
+	// Single digits use the binary GCD, mid-range sizes Lehmer's algorithm
+	// and the largest numbers are first reduced by the half GCD, which
+	// takes the steps of Euclid's algorithm from the top digits, recursively.
+
+	// Binary GCD (Stein's algorithm), for single digits
+	static digit binary_gcd(digit x, digit y) {
+		if (!x) {
+			return y;
+		}
+		if (!y) {
+			return x;
+		}
+
+		auto shift = _ctz(x | y);
+		x >>= _ctz(x);
+		do {
+			y >>= _ctz(y);
+			if (x > y) {
+				std::swap(x, y);
+			}
+			y -= x;
+		} while (y);
+		return x << shift;
+	}
+
+	// A helper for Lehmer's GCD to get the bits of num from the given bit up,
+	// as many as fit in T (the caller makes sure there are no more than that).
+	template <typename T>
+	static T lehmer_bits(const uinteger_t& num, std::size_t bit) {
+		auto sz = num.size();
+		auto n = num.data();
+		auto i = bit / digit_bits;
+		auto shift = bit % digit_bits;
+
+		T result = i < sz ? n[i] >> shift : 0;
+		for (std::size_t j = 1; j * digit_bits - shift < sizeof(T) * 8 && i + j < sz; ++j) {
+			result |= static_cast<T>(n[i + j]) << (j * digit_bits - shift);
+		}
+		return result;
+	}
+
+	// A helper for Lehmer's GCD, most quotients are small,
+	// so a few subtractions are tried before dividing.
+	template <typename T>
+	static T lehmer_quotient(T x, T y) {
+		T q = 0;
+		for (; q < 4; ++q) {
+			if (x < y) {
+				return q;
+			}
+			x -= y;
+		}
+		return q + x / y;
+	}
+
+	// A helper for Lehmer's GCD, runs Euclid's algorithm on the leading bits of
+	// a and b (a >= b, with at least two digits) for as long as the quotients are
+	// sure to be the same as for the full numbers (Knuth's Algorithm L), and gets
+	// the cofactors to take all those steps at once:
+	//   a' = A * a + B * b
+	//   b' = C * a + D * b
+	// The cofactors are returned as magnitudes, their signs alternate with the
+	// number of steps taken (which is returned, zero if none could be taken).
+	// The leading bits are as many as fit in T, with two bits to spare for the
+	// signs and the sums, so the cofactors end up fitting in half of T.
+	// Stops early if the remainders get close to 2^min_bits.
+	template <typename T, typename U = std::make_unsigned_t<T>>
+	static std::size_t lehmer_cofactors(const uinteger_t& a, const uinteger_t& b, digit* cofactors, std::size_t min_bits) {
+		auto bits = a.bits();
+		auto bit = bits > sizeof(T) * 8 - 2 ? bits - (sizeof(T) * 8 - 2) : 0;
+		auto x = static_cast<T>(lehmer_bits<U>(a, bit));
+		auto y = static_cast<T>(lehmer_bits<U>(b, bit));
+
+		T min = 0;
+		if (min_bits >= bit) {
+			if (min_bits - bit + 1 >= sizeof(T) * 8 - 2) {
+				return 0;
+			}
+			min = static_cast<T>(1) << (min_bits - bit + 1);
+		}
+
+		T A = 1, B = 0, C = 0, D = 1;
+		std::size_t steps = 0;
+		while (y + C && y + D) {
+			auto q = lehmer_quotient(x + A, y + C);
+			if (q != lehmer_quotient(x + B, y + D)) {
+				break;
+			}
+			auto t = x - q * y;
+			if (t < min) {
+				break;
+			}
+			x = y;
+			y = t;
+			t = A - q * C;
+			A = C;
+			C = t;
+			t = B - q * D;
+			B = D;
+			D = t;
+			++steps;
+		}
+
+		cofactors[0] = static_cast<digit>(A < 0 ? -A : A);
+		cofactors[1] = static_cast<digit>(B < 0 ? -B : B);
+		cofactors[2] = static_cast<digit>(C < 0 ? -C : C);
+		cofactors[3] = static_cast<digit>(D < 0 ? -D : D);
+		return steps;
+	}
+
+	static std::size_t lehmer_cofactors(const uinteger_t& a, const uinteger_t& b, digit* cofactors, std::size_t min_bits = 0) {
+	#if defined HAVE____INT128_T
+		if (digit_bits == 64) {
+			return lehmer_cofactors<__int128_t, __uint128_t>(a, b, cofactors, min_bits);
+		}
+	#endif
+		return lehmer_cofactors<std::make_signed_t<digit>>(a, b, cofactors, min_bits);
+	}
+
+	// A helper for Lehmer's GCD, result = x * lhs - y * rhs (which must not be
+	// negative), or result = x * lhs + y * rhs when adding (for the cofactors).
+	static uinteger_t& lehmer_combine(uinteger_t& result, digit x, const uinteger_t& lhs, digit y, const uinteger_t& rhs, bool adding = false) {
+		auto lhs_sz = lhs.size();
+		auto rhs_sz = rhs.size();
+		auto sz = std::max(lhs_sz, rhs_sz);
+
+		result.resize(sz + 2);
+
+		auto a = lhs.data();
+		auto b = rhs.data();
+		auto r = result.data();
+
+		digit x_carry = 0;
+		digit y_carry = 0;
+		digit carry = 0;
+		for (std::size_t i = 0; i < sz; ++i) {
+			digit x_lo, y_lo;
+			x_carry = _multadd(i < lhs_sz ? a[i] : 0, x, 0, x_carry, &x_lo);
+			y_carry = _multadd(i < rhs_sz ? b[i] : 0, y, 0, y_carry, &y_lo);
+			if (adding) {
+				carry = _addcarry(x_lo, y_lo, carry, &r[i]);
+			} else {
+				carry = _subborrow(x_lo, y_lo, carry, &r[i]);
+			}
+		}
+		if (adding) {
+			r[sz + 1] = _addcarry(x_carry, y_carry, carry, &r[sz]);
+		} else {
+			r[sz + 1] = _subborrow(x_carry, y_carry, carry, &r[sz]);
+			assert(!r[sz + 1]);
+		}
+
+		// Finish up
+		result.trim();
+		return result;
+	}
+
+	// A helper for Lehmer's GCD to apply the cofactors to a and b,
+	// the results are left in x and y (x > y).
+	static void lehmer_apply(uinteger_t& x, uinteger_t& y, const uinteger_t& a, const uinteger_t& b, const digit* cofactors, std::size_t steps) {
+		if (steps & 1) {
+			lehmer_combine(x, cofactors[1], b, cofactors[0], a);
+			lehmer_combine(y, cofactors[2], a, cofactors[3], b);
+		} else {
+			lehmer_combine(x, cofactors[0], a, cofactors[1], b);
+			lehmer_combine(y, cofactors[3], b, cofactors[2], a);
+		}
+	}
+
+	// A helper for the half GCD, M = M * M1 (matrices as arrays of four numbers).
+	static void half_gcd_matrix_mult(uinteger_t* M, const uinteger_t* M1) {
+		for (std::size_t i = 0; i < 4; i += 2) {
+			auto m0 = M[i] * M1[0] + M[i + 1] * M1[2];
+			M[i + 1] = M[i] * M1[1] + M[i + 1] * M1[3];
+			M[i] = std::move(m0);
+		}
+	}
+
+	// A helper for the half GCD, M = M * M1 (for a matrix M1 of single digits).
+	static void half_gcd_matrix_mult(uinteger_t* M, const digit* M1) {
+		uinteger_t x(M[0].get_allocator()), y(M[0].get_allocator());
+		for (std::size_t i = 0; i < 4; i += 2) {
+			lehmer_combine(x, M1[0], M[i], M1[2], M[i + 1], true);
+			lehmer_combine(y, M1[1], M[i], M1[3], M[i + 1], true);
+			std::swap(M[i], x);
+			std::swap(M[i + 1], y);
+		}
+	}
+
+	// A helper for the half GCD, takes a step reducing a and b, but only as long
+	// as both stay above B^s (which makes the step the same one no matter what
+	// lower digits they could have), and updates M. Steps are either a Lehmer
+	// step or a single division, and don't swap a and b, so M keeps its
+	// determinant as one. Returns false if no such step can be taken.
+	static bool half_gcd_step(uinteger_t& a, uinteger_t& b, uinteger_t* M, std::size_t s) {
+		bool swapped = compare(a, b) < 0;
+		auto& big = swapped ? b : a;
+		auto& small = swapped ? a : b;
+
+		if (small.size() > s) {
+			digit cofactors[4];
+			if (auto steps = lehmer_cofactors(big, small, cofactors, s * digit_bits)) {
+				uinteger_t x(a.get_allocator()), y(a.get_allocator());
+				lehmer_apply(x, y, big, small, cofactors, steps);
+				if (y.size() > s) {
+					// The steps are the inverse of the cofactors, with the
+					// columns swapped for odd steps (so big and small stay in place):
+					digit M1[4];
+					if (steps & 1) {
+						std::swap(big, y);
+						std::swap(small, x);
+						M1[0] = cofactors[1]; M1[1] = cofactors[3];
+						M1[2] = cofactors[0]; M1[3] = cofactors[2];
+					} else {
+						std::swap(big, x);
+						std::swap(small, y);
+						M1[0] = cofactors[3]; M1[1] = cofactors[1];
+						M1[2] = cofactors[2]; M1[3] = cofactors[0];
+					}
+					if (swapped) {
+						std::swap(M1[0], M1[3]);
+						std::swap(M1[1], M1[2]);
+					}
+					half_gcd_matrix_mult(M, M1);
+					return true;
+				}
+			}
+		}
+
+		uinteger_t q(a.get_allocator()), r(a.get_allocator());
+		divmod(q, r, big, small);
+		if (r.size() <= s) {
+			if (compare(q, uint_1()) == 0) {
+				return false;
+			}
+			sub(q, uint_1());
+			add(r, small);
+		}
+		big = std::move(r);
+
+		// big = big' + q * small, so q times the column of big is added to
+		// the column of small:
+		auto cb = swapped ? 1 : 0;
+		auto cs = swapped ? 0 : 1;
+		add(M[cs], q * M[cb]);
+		add(M[cs + 2], q * M[cb + 2]);
+		return true;
+	}
+
+	// A helper for the half GCD, reduces a and b by the half GCD of their top
+	// digits (from digit p up), adjusting the lower digits with M:
+	//   a' = a_hi' * B^p + M11 * a_lo - M01 * b_lo
+	//   b' = b_hi' * B^p + M00 * b_lo - M10 * a_lo
+	static bool half_gcd_reduce(uinteger_t& a, uinteger_t& b, uinteger_t* M, std::size_t p) {
+		auto shift = p * digit_bits;
+		auto a_hi = a >> shift;
+		auto b_hi = b >> shift;
+		if (!half_gcd(a_hi, b_hi, M)) {
+			return false;
+		}
+
+		auto a_lo = split_piece(a, p, 0);
+		auto b_lo = split_piece(b, p, 0);
+
+		auto x = (a_hi << shift) + M[3] * a_lo;
+		auto y = M[1] * b_lo;
+		assert(compare(x, y) >= 0);
+		a = x - y;
+
+		x = (b_hi << shift) + M[0] * b_lo;
+		y = M[2] * a_lo;
+		assert(compare(x, y) >= 0);
+		b = x - y;
+		return true;
+	}
+
+	// Half GCD
+	//
+	// Based on "On Schonhage's algorithm and subquadratic integer gcd
+	// computation" by Niels Moller, reduces a and b (of up to n digits) until
+	// their difference fits in s = n / 2 + 1 digits, and gets the matrix of
+	// the steps taken, M = [M00 M01; M10 M11], such that (a, b) = M (a', b').
+	// The steps are taken from the half GCD of the top digits, recursively:
+	// first from the top half, and then from the top half of what's left.
+	// Returns false if no reduction was possible.
+	static bool half_gcd(uinteger_t& a, uinteger_t& b, uinteger_t* M) {
+		auto n = std::max(a.size(), b.size());
+		auto s = n / 2 + 1;
+
+		M[0] = uint_1();
+		M[1] = uint_0();
+		M[2] = uint_0();
+		M[3] = uint_1();
+
+		if (std::min(a.size(), b.size()) <= s) {
+			return false;
+		}
+
+		bool success = false;
+		if (n > half_gcd_cutoff) {
+			success = half_gcd_reduce(a, b, M, n / 2);
+
+			auto n2 = 3 * n / 4 + 1;
+			n = std::max(a.size(), b.size());
+			while (n > n2) {
+				if (!half_gcd_step(a, b, M, s)) {
+					return success;
+				}
+				success = true;
+				n = std::max(a.size(), b.size());
+			}
+
+			if (n > s + 2) {
+				uinteger_t M1[4] = {uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator())};
+				if (half_gcd_reduce(a, b, M1, 2 * s - n + 1)) {
+					half_gcd_matrix_mult(M, M1);
+					success = true;
+				}
+			}
+		}
+
+		while (half_gcd_step(a, b, M, s)) {
+			success = true;
+		}
+		return success;
+	}
+
+	// A helper for GCD, reduces a and b (a >= b) by about a quarter of their
+	// size (using the half GCD of their top half) and keeps them in order,
+	// or takes a single step of Euclid's algorithm if that's not possible,
+	// and gets the matrix of the steps taken.
+	// Returns true if the determinant of the matrix is minus one.
+	static bool gcd_reduce(uinteger_t& a, uinteger_t& b, uinteger_t* M) {
+		if (half_gcd_reduce(a, b, M, a.size() / 2)) {
+			if (compare(a, b) < 0) {
+				std::swap(a, b);
+				std::swap(M[0], M[1]);
+				std::swap(M[2], M[3]);
+				return true;
+			}
+			return false;
+		} else {
+			uinteger_t q(a.get_allocator()), r(a.get_allocator());
+			divmod(q, r, a, b);
+			std::swap(a, b);
+			std::swap(b, r);
+			M[0] = std::move(q);
+			M[1] = uint_1();
+			M[2] = uint_1();
+			M[3] = uint_0();
+			return true;
+		}
+	}
+
+	static uinteger_t& gcd(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		// First try saving some calculations:
+		if (!rhs) {
+			result = lhs;
+			return result;
+		}
+		if (!lhs) {
+			result = rhs;
+			return result;
+		}
+
+		uinteger_t a(lhs);
+		uinteger_t b(rhs);
+		if (compare(a, b) < 0) {
+			std::swap(a, b);
+		}
+
+		uinteger_t M[4] = {uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator())};
+		while (b.size() > gcd_half_gcd_cutoff) {
+			gcd_reduce(a, b, M);
+		}
+
+		digit cofactors[4];
+		uinteger_t x(lhs.get_allocator()), y(lhs.get_allocator());
+		while (b.size() > 1) {
+			if (auto steps = lehmer_cofactors(a, b, cofactors)) {
+				lehmer_apply(x, y, a, b, cofactors, steps);
+				std::swap(a, x);
+				std::swap(b, y);
+			} else {
+				divmod(x, y, a, b);
+				std::swap(a, b);
+				std::swap(b, y);
+			}
+		}
+
+		if (!b) {
+			result = std::move(a);
+			return result;
+		}
+
+		// Finish up with a single digit
+		auto n = b.front();
+		digit r = 0;
+		for (auto rit = a.rbegin(); rit != a.rend(); ++rit) {
+			digit q;
+			r = _divmod(r, *rit, n, &q);
+		}
+		result = binary_gcd(n, r);
+		return result;
+	}
+
+	static uinteger_t gcd(const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t result(lhs.get_allocator());
+		gcd(result, lhs, rhs);
+		return result;
+	}
+
+	static uinteger_t& lcm(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		if (!lhs || !rhs) {
+			result = uint_0();
+			return result;
+		}
+		result = lhs / gcd(lhs, rhs) * rhs;
+		return result;
+	}
+
+	static uinteger_t lcm(const uinteger_t& lhs, const uinteger_t& rhs) {
+		uinteger_t result(lhs.get_allocator());
+		lcm(result, lhs, rhs);
+		return result;
+	}
+
+	// A helper for the extended GCD, reduces a and b (a >= b) down to (g, 0)
+	// and applies the same steps to the cofactors (u0, u1). Their signs are
+	// opposite, so only their magnitudes are kept, along with the sign of u0.
+	static void gcdext_reduce(uinteger_t& a, uinteger_t& b, uinteger_t& u0, uinteger_t& u1, bool& negative) {
+		uinteger_t M[4] = {uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator()), uinteger_t(a.get_allocator())};
+		while (b.size() > gcd_half_gcd_cutoff) {
+			// (u0, u1) = M^-1 (u0, u1), which for the magnitudes is a sum,
+			// and the signs swap when the determinant is minus one:
+			if (gcd_reduce(a, b, M)) {
+				negative = !negative;
+			}
+			auto v0 = M[3] * u0 + M[1] * u1;
+			u1 = M[0] * u1 + M[2] * u0;
+			u0 = std::move(v0);
+		}
+
+		digit cofactors[4];
+		uinteger_t x(a.get_allocator()), y(a.get_allocator());
+		while (b) {
+			if (b.size() > 1) {
+				if (auto steps = lehmer_cofactors(a, b, cofactors)) {
+					lehmer_apply(x, y, a, b, cofactors, steps);
+					std::swap(a, x);
+					std::swap(b, y);
+					lehmer_combine(x, cofactors[0], u0, cofactors[1], u1, true);
+					lehmer_combine(y, cofactors[2], u0, cofactors[3], u1, true);
+					std::swap(u0, x);
+					std::swap(u1, y);
+					negative ^= steps & 1;
+					continue;
+				}
+			}
+			divmod(x, y, a, b);
+			std::swap(a, b);
+			std::swap(b, y);
+			x = u0 + x * u1;
+			u0 = std::move(u1);
+			u1 = std::move(x);
+			negative = !negative;
+		}
+	}
+
+	// Extended GCD, gets g = gcd(lhs, rhs) and the cofactors s and t such that
+	// lhs * s = g (mod rhs) and rhs * t = g (mod lhs), reduced so that s < rhs / g
+	// and t < lhs / g (so, for instance, s is the inverse of lhs modulo rhs
+	// when g is one). Same algorithms as gcd(), but keeping track of the cofactor
+	// of the largest number, t is found from s at the end.
+	static std::tuple<uinteger_t, uinteger_t, uinteger_t> gcdext(const uinteger_t& lhs, const uinteger_t& rhs) {
+		if (compare(lhs, rhs) < 0) {
+			auto result = gcdext(rhs, lhs);
+			return std::make_tuple(std::move(std::get<0>(result)), std::move(std::get<2>(result)), std::move(std::get<1>(result)));
+		}
+		if (!rhs) {
+			return std::make_tuple(lhs, uint_1(lhs.get_allocator()), uinteger_t(lhs.get_allocator()));
+		}
+
+		// Invariants: a = u0 * lhs (mod rhs) and b = u1 * lhs (mod rhs)
+		uinteger_t a(lhs);
+		uinteger_t b(rhs);
+		uinteger_t u0 = uint_1(lhs.get_allocator());
+		uinteger_t u1(lhs.get_allocator());
+		bool negative = false;
+		gcdext_reduce(a, b, u0, u1, negative);
+
+		// Finish up, getting s = +/-u0 (mod rhs / g) and t from it:
+		auto m = rhs / a;
+		auto s = u0 % m;
+		if (negative && s) {
+			s = m - s;
+		}
+		auto n = lhs / a;
+		uinteger_t t(lhs.get_allocator());
+		if (s) {
+			t = (lhs * s - a) / rhs % n;
+			if (t) {
+				t = n - t;
+			}
+		} else {
+			// g = rhs, which is rhs * 1
+			t = uint_1(lhs.get_allocator()) % n;
+		}
+		return std::make_tuple(std::move(a), std::move(s), std::move(t));
+	}
+
+	// Modular inverse, like gcdext() but keeping track of the cofactor of
+	// the smallest number instead (value), so there's no t to find at the end.
+	static uinteger_t& invmod(uinteger_t& result, const uinteger_t& value, const uinteger_t& mod) {
+		if (!mod) {
+			throw std::domain_error("Error: division or modulus by 0");
+		}
+
+		// Invariants: a = -u0 * value (mod mod) and b = u1 * value (mod mod)
+		uinteger_t a(mod);
+		uinteger_t b(value.get_allocator());
+		uinteger_t quotient(value.get_allocator());
+		divmod(quotient, b, value, mod);
+		uinteger_t u0(value.get_allocator());
+		uinteger_t u1 = uint_1(value.get_allocator());
+		bool negative = true;
+		gcdext_reduce(a, b, u0, u1, negative);
+		if (compare(a, uint_1()) != 0) {
+			throw std::domain_error("Error: not invertible");
+		}
+
+		// Finish up
+		divmod(quotient, result, u0, mod);
+		if (negative && result) {
+			result = mod - result;
+		}
+		return result;
+	}
+
+	static uinteger_t invmod(const uinteger_t& value, const uinteger_t& mod) {
+		uinteger_t result(value.get_allocator());
+		invmod(result, value, mod);
+		return result;
+	}
+
+	// Integer roots
+
+	// Integer square root, floor(sqrt(num)), using Newton's method with
+	// growing precision: each step doubles the bits of the root of the top
+	// of num, with a single division by a number of about that size.
+	static uinteger_t& isqrt(uinteger_t& result, const uinteger_t& num) {
+		if (compare(num, uinteger_t(4)) < 0) {
+			result = num ? uint_1() : uint_0();
+			return result;
+		}
+
+		auto c = (num.bits() - 1) / 2;
+		auto a = uint_1(num.get_allocator());
+		std::size_t d = 0;
+		for (auto s = _bits(c); s--;) {
+			auto e = d;
+			d = c >> s;
+			a = (a << (d - e - 1)) + (num >> (2 * c - e - d + 1)) / a;
+		}
+
+		// Finish up, a is the root or one past it
+		uinteger_t square(num.get_allocator());
+		sqr(square, a);
+		if (compare(square, num) > 0) {
+			--a;
+		}
+		result = std::move(a);
+		return result;
+	}
+
+	static uinteger_t isqrt(const uinteger_t& num) {
+		uinteger_t result(num.get_allocator());
+		isqrt(result, num);
+		return result;
+	}
+
+	static std::pair<std::reference_wrapper<uinteger_t>, std::reference_wrapper<uinteger_t>> isqrt_rem(uinteger_t& root, uinteger_t& remainder, const uinteger_t& num) {
+		uinteger_t r(num.get_allocator());
+		uinteger_t square(num.get_allocator());
+		isqrt(r, num);
+		sqr(square, r);
+		remainder = num - square;
+		root = std::move(r);
+		return std::make_pair(std::ref(root), std::ref(remainder));
+	}
+
+	static std::pair<uinteger_t, uinteger_t> isqrt_rem(const uinteger_t& num) {
+		uinteger_t root(num.get_allocator());
+		uinteger_t remainder(num.get_allocator());
+		isqrt_rem(root, remainder, num);
+		return std::make_pair(std::move(root), std::move(remainder));
+	}
+
+	// Integer k-th root, floor(num^(1/k)). The root of the top half of the
+	// bits is found recursively (down to roots that can be estimated with
+	// doubles), and then Newton's method, which after its first step stays
+	// above the root, takes it the rest of the way in a few steps.
+	static uinteger_t& iroot(uinteger_t& result, const uinteger_t& num, std::size_t k) {
+		if (!k) {
+			throw std::domain_error("Error: zeroth root");
+		}
+		if (k == 1 || compare(num, uint_1()) <= 0) {
+			result = num;
+			return result;
+		}
+		if (k == 2) {
+			return isqrt(result, num);
+		}
+
+		auto bits = num.bits();
+		auto root_bits = (bits + k - 1) / k;
+		uinteger_t x(num.get_allocator());
+		if (root_bits <= 48) {
+			// From log2(num), using the top digits:
+			auto shift = bits > 64 ? bits - 64 : 0;
+			auto top = static_cast<std::uint64_t>(num >> shift);
+			auto estimate = std::exp2((std::log2(static_cast<double>(top)) + shift) / k);
+			x = static_cast<std::uint64_t>(estimate) + 1;
+		} else {
+			auto shift = root_bits / 2;
+			iroot(x, num >> (shift * k), k);
+			x = (x + uint_1()) << shift;
+		}
+
+		const auto alloc = num.get_allocator();
+		uinteger_t q(alloc), r(alloc), y(alloc);
+		for (bool first = true; ; first = false) {
+			divmod(q, r, num, pow(x, k - 1));
+			y = (x * (k - 1) + q) / k;
+			if (!first && compare(y, x) >= 0) {
+				break;
+			}
+			x = std::move(y);
+		}
+		result = std::move(x);
+		return result;
+	}
+
+	static uinteger_t iroot(const uinteger_t& num, std::size_t k) {
+		uinteger_t result(num.get_allocator());
+		iroot(result, num, k);
+		return result;
+	}
+
+	// Bitmask of the squares modulo m (for m up to 64)
+	static constexpr std::uint64_t _squares(std::uint64_t m) {
+		std::uint64_t mask = 0;
+		for (std::uint64_t i = 0; i < m; ++i) {
+			mask |= std::uint64_t(1) << (i * i % m);
+		}
+		return mask;
+	}
+
+	// Quickly rules out most non-squares by their residues modulo 64 and
+	// modulo a few small numbers (all but about 1 in 600 of them), before
+	// taking the square root.
+	static bool is_perfect_square(const uinteger_t& num) {
+		if (!num) {
+			return true;
+		}
+		constexpr auto squares_64 = _squares(64);
+		if (!((squares_64 >> (num.front() & 63)) & 1)) {
+			return false;
+		}
+
+		if (digit_bits >= 32) {
+			constexpr digit moduli[] = {63, 25, 11, 17, 19, 23};
+			constexpr std::uint64_t squares[] = {_squares(63), _squares(25), _squares(11), _squares(17), _squares(19), _squares(23)};
+			auto r = single_mod(num, 63 * 25 * 11 * 17 * 19 * 23);
+			for (std::size_t i = 0; i < 6; ++i) {
+				if (!((squares[i] >> (r % moduli[i])) & 1)) {
+					return false;
+				}
+			}
+		}
+
+		uinteger_t root(num.get_allocator());
+		uinteger_t remainder(num.get_allocator());
+		isqrt_rem(root, remainder, num);
+		return !remainder;
+	}
+
+	// Primality
+
+	// Remainder of lhs modulo a single digit
+	static digit single_mod(const uinteger_t& lhs, digit rhs) {
+		digit r;
+		mod_small(lhs, &rhs, 1, &r);
+		return r;
+	}
+
+	// Jacobi symbol (a/n), for odd n
+	static int _jacobi(digit a, digit n) {
+		int result = 1;
+		a %= n;
+		while (a) {
+			while (!(a & 1)) {
+				a >>= 1;
+				if ((n & 7) == 3 || (n & 7) == 5) {
+					result = -result;
+				}
+			}
+			std::swap(a, n);
+			if ((a & 3) == 3 && (n & 3) == 3) {
+				result = -result;
+			}
+			a %= n;
+		}
+		return n == 1 ? result : 0;
+	}
+
+	// Odd primes below 2^16 (or below half a digit), and the products of runs
+	// of them that fit in a digit, so that a single remainder by a product
+	// gives the remainders by all of its primes.
+	struct small_primes_table {
+		std::vector<digit> primes;
+		std::vector<digit> products;
+		std::vector<std::size_t> ends;  // products[i] ends right before primes[ends[i]]
+		std::size_t trial_products;     // products of the primes below 1024
+	};
+
+	static small_primes_table small_primes_init() {
+		auto limit = digit(1) << std::min<std::size_t>(16, half_digit_bits);
+		std::vector<bool> composite(limit);
+		small_primes_table table;
+		for (digit i = 3; i < limit; i += 2) {
+			if (!composite[i]) {
+				table.primes.push_back(i);
+				for (auto j = i * i; j < limit; j += 2 * i) {
+					composite[j] = true;
+				}
+			}
+		}
+
+		digit product = 1;
+		for (std::size_t i = 0; i < table.primes.size(); ++i) {
+			auto p = table.primes[i];
+			if (product > std::numeric_limits<digit>::max() / p) {
+				table.products.push_back(product);
+				table.ends.push_back(i);
+				product = 1;
+			}
+			product *= p;
+		}
+		table.products.push_back(product);
+		table.ends.push_back(table.primes.size());
+
+		table.trial_products = 0;
+		while (table.trial_products < table.products.size() && table.primes[table.ends[table.trial_products] - 1] < 1024) {
+			++table.trial_products;
+		}
+		if (table.trial_products < table.products.size()) {
+			++table.trial_products;
+		}
+		return table;
+	}
+
+	static const small_primes_table& small_primes() {
+		static const small_primes_table table = small_primes_init();
+		return table;
+	}
+
+	// Gets the remainders of num by the first count small primes
+	static void small_primes_remainders(std::vector<digit>& remainders, const uinteger_t& num, std::size_t count) {
+		const auto& table = small_primes();
+		remainders.clear();
+		if (!count) {
+			return;
+		}
+		auto groups = static_cast<std::size_t>(std::upper_bound(table.ends.begin(), table.ends.end(), count - 1) - table.ends.begin()) + 1;
+		std::vector<digit> products_remainders(groups);
+		mod_small(num, table.products.data(), groups, products_remainders.data());
+		for (std::size_t g = 0, i = 0; i < count; ++g) {
+			for (; i < table.ends[g] && i < count; ++i) {
+				remainders.push_back(products_remainders[g] % table.primes[i]);
+			}
+		}
+	}
+
+	// Strong probable prime tests, for odd n (defined after the contexts),
+	// to base a with n - 1 = d * 2^s, and the strong Lucas test with P = 1,
+	// and D and Q = (1 - D) / 4 modulo n.
+	static bool miller_rabin(const montgomery_context& ctx, const uinteger_t& a, const uinteger_t& d, std::size_t s);
+	static bool strong_lucas(const montgomery_context& ctx, const uinteger_t& D, const uinteger_t& Q);
+
+	// Baillie-PSW, for odd n with no small factors: Miller-Rabin to base 2
+	// and the strong Lucas test (with D chosen by Selfridge's method), and
+	// then rounds of Miller-Rabin to bases 3, 5, 7...
+	static bool baillie_psw(const uinteger_t& n, std::size_t rounds);
+
+	// Probable prime test, trial division by the primes below 1024 (taking
+	// the remainders by their products) before Baillie-PSW, which has no
+	// known counterexamples.
+	static bool is_probable_prime(const uinteger_t& num, std::size_t rounds = 0) {
+		const auto& table = small_primes();
+		if (num.size() <= 1) {
+			auto n = num ? num.front() : 0;
+			if (n < 3) {
+				return n == 2;
+			}
+			if (n <= table.primes.back()) {
+				return std::binary_search(table.primes.begin(), table.primes.end(), n);
+			}
+		}
+		if (!(num.front() & 1)) {
+			return false;
+		}
+
+		digit remainders[64];
+		assert(table.trial_products <= 64);
+		mod_small(num, table.products.data(), table.trial_products, remainders);
+		for (std::size_t g = 0, i = 0; g < table.trial_products; i = table.ends[g++]) {
+			for (auto j = i; j < table.ends[g]; ++j) {
+				if (remainders[g] % table.primes[j] == 0) {
+					return false;
+				}
+			}
+		}
+		if (compare(num, uinteger_t(1024 * 1024)) < 0) {
+			return true;
+		}
+
+		return baillie_psw(num, rounds);
+	}
+
+	// Next prime after num, sieving windows of odd candidates by the small
+	// primes (more of them for bigger numbers) and testing the survivors.
+	static uinteger_t next_prime(const uinteger_t& num) {
+		const auto& table = small_primes();
+		if (compare(num, table.primes.back()) < 0) {
+			if (compare(num, uinteger_t(2)) < 0) {
+				return uinteger_t(2);
+			}
+			return uinteger_t(*std::upper_bound(table.primes.begin(), table.primes.end(), num.front()));
+		}
+
+		auto start = num + ((num.front() & 1) ? uinteger_t(2) : uint_1());
+		auto bits = start.bits();
+		auto sieve_limit = std::min<digit>(table.primes.back(), 16 * bits);
+		auto count = static_cast<std::size_t>(std::upper_bound(table.primes.begin(), table.primes.end(), sieve_limit) - table.primes.begin());
+		std::size_t window = std::max<std::size_t>(256, bits);
+
+		std::vector<digit> remainders;
+		small_primes_remainders(remainders, start, count);
+		std::vector<char> composite(window);
+		while (true) {
+			// Marks start + 2 * j, for the j where it's a multiple of p:
+			std::fill(composite.begin(), composite.end(), 0);
+			for (std::size_t i = 0; i < count; ++i) {
+				auto p = table.primes[i];
+				auto r = remainders[i];
+				auto j = r ? (p - r) * ((p + 1) / 2) % p : 0;
+				for (; j < window; j += p) {
+					composite[j] = 1;
+				}
+			}
+
+			for (std::size_t j = 0; j < window; ++j) {
+				if (!composite[j]) {
+					auto candidate = start + uinteger_t(2 * j);
+					if (baillie_psw(candidate, 0)) {
+						return candidate;
+					}
+				}
+			}
+
+			start += uinteger_t(2 * window);
+			for (std::size_t i = 0; i < count; ++i) {
+				remainders[i] = (remainders[i] + 2 * window) % table.primes[i];
+			}
+		}
+	}
+
+private:
+	// Constructors
+
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	void _uint_t(const T& value) {
+		append(static_cast<digit>(value));
+	}
+
+	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	void _uint_t(const T& value, Args... args) {
+		_uint_t(args...);
+		append(static_cast<digit>(value));
+	}
+
+	// This constructor creates a window view of the _value
+	basic_uinteger_t(const uinteger_t& o, std::size_t begin, std::size_t end) :
+		_begin(begin),
+		_end(end),
+		_value(o._value),
+		_carry(o._carry) { }
+
+	// Temporaries (scratch), with their digits in the scratch arena of the
+	// thread, must not outlive the functions that create them.
+	basic_uinteger_t(const allocator_type& alloc, bool scratch) :
+		_begin(0),
+		_end(0),
+		_value_instance(alloc, scratch),
+		_value(_value_instance),
+		_carry(false) { }
+
+public:
+	basic_uinteger_t() :
+		_begin(0),
+		_end(0),
+		_value(_value_instance),
+		_carry(false) { }
+
+	explicit basic_uinteger_t(const allocator_type& alloc) :
+		_begin(0),
+		_end(0),
+		_value_instance(alloc),
+		_value(_value_instance),
+		_carry(false) { }
+
+	basic_uinteger_t(const uinteger_t& o) :
+		_begin(0),
+		_end(0),
+		_value_instance(o.begin(), o.end(), std::allocator_traits<allocator_type>::select_on_container_copy_construction(o.get_allocator())),
+		_value(_value_instance),
+		_carry(o._carry) { }
+
+	basic_uinteger_t(const uinteger_t& o, const allocator_type& alloc) :
+		_begin(0),
+		_end(0),
+		_value_instance(o.begin(), o.end(), alloc),
+		_value(_value_instance),
+		_carry(o._carry) { }
+
+	basic_uinteger_t(uinteger_t&& o) :
+		_begin(std::move(o._begin)),
+		_end(std::move(o._end)),
+		_value_instance(std::move(o._value_instance)),
+		_value(_value_instance),
+		_carry(std::move(o._carry)) { }
+
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	basic_uinteger_t(const T& value) :
+		_begin(0),
+		_end(0),
+		_value(_value_instance),
+		_carry(false) {
+		if (value) {
+			append(static_cast<digit>(value));
+		}
+	}
+
+	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	basic_uinteger_t(const T& value, Args... args) :
+		_begin(0),
+		_end(0),
+		_value(_value_instance),
+		_carry(false) {
+		_uint_t(args...);
+		append(static_cast<digit>(value));
+		trim();
+	}
+
+	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	basic_uinteger_t(std::initializer_list<T> list) :
+		_begin(0),
+		_end(0),
+		_value(_value_instance),
+		_carry(false) {
+		reserve(list.size());
+		for (const auto& value : list) {
+			append(static_cast<digit>(value));
+		}
+		trim();
+	}
+
+	template <typename T, std::size_t N>
+	explicit basic_uinteger_t(T (&&s)[N], int base=10) :
+		basic_uinteger_t(s, N - 1, base) { }
+
+	explicit basic_uinteger_t(const unsigned char* bytes, std::size_t sz, int base) :
+		basic_uinteger_t(strtouint(bytes, sz, base)) { }
+
+	explicit basic_uinteger_t(const char* bytes, std::size_t sz, int base) :
+		basic_uinteger_t(strtouint(bytes, sz, base)) { }
+
+	template <typename T>
+	explicit basic_uinteger_t(const std::vector<T>& bytes, int base=10) :
+		basic_uinteger_t(bytes.data(), bytes.size(), base) { }
+
+	explicit basic_uinteger_t(const std::string& bytes, int base=10) :
+		basic_uinteger_t(bytes.data(), bytes.size(), base) { }
+
+	// Assignment Operator
+	uinteger_t& operator=(const uinteger_t& o) {
+		if (this != &o) {
+			_value.assign(o.begin(), o.end());
+			_begin = 0;
+			_end = 0;
+			_carry = o._carry;
+		}
+		return *this;
+	}
+	uinteger_t& operator=(uinteger_t&& o) {
+		_begin = std::move(o._begin);
+		_end = std::move(o._end);
+		_value_instance = std::move(o._value_instance);
+		_carry = std::move(o._carry);
+		return *this;
+	}
+
+	// Typecast Operators
+	explicit operator bool() const {
+		return static_cast<bool>(size());
+	}
+	explicit operator unsigned char() const {
+		return static_cast<unsigned char>(size() ? front() : 0);
+	}
+	explicit operator unsigned short() const {
+		return static_cast<unsigned short>(size() ? front() : 0);
+	}
+	explicit operator unsigned int() const {
+		return static_cast<unsigned int>(size() ? front() : 0);
+	}
+	explicit operator unsigned long() const {
+		return static_cast<unsigned long>(size() ? front() : 0);
+	}
+	explicit operator unsigned long long() const {
+		return static_cast<unsigned long long>(size() ? front() : 0);
+	}
+	explicit operator char() const {
+		return static_cast<char>(size() ? front() : 0);
+	}
+	explicit operator short() const {
+		return static_cast<short>(size() ? front() : 0);
+	}
+	explicit operator int() const {
+		return static_cast<int>(size() ? front() : 0);
+	}
+	explicit operator long() const {
+		return static_cast<long>(size() ? front() : 0);
+	}
+	explicit operator long long() const {
+		return static_cast<long long>(size() ? front() : 0);
+	}
+
+	// Bitwise Operators
+	uinteger_t operator&(const uinteger_t& rhs) const {
+		return bitwise_and(*this, rhs);
+	}
+
+	uinteger_t& operator&=(const uinteger_t& rhs) {
+		return bitwise_and(*this, rhs);
+	}
+
+	uinteger_t operator|(const uinteger_t& rhs) const {
+		return bitwise_or(*this, rhs);
+	}
+
+	uinteger_t& operator|=(const uinteger_t& rhs) {
+		return bitwise_or(*this, rhs);
+	}
+
+	uinteger_t operator^(const uinteger_t& rhs) const {
+		return bitwise_xor(*this, rhs);
+	}
+
+	uinteger_t& operator^=(const uinteger_t& rhs) {
+		return bitwise_xor(*this, rhs);
+	}
+
+	uinteger_t operator~() const {
+		return bitwise_inv(*this);
+	}
+
+	uinteger_t inv() {
+		return bitwise_inv(*this);
+	}
+
+	// Bit Shift Operators
+	uinteger_t operator<<(const uinteger_t& rhs) const {
+		return bitwise_lshift(*this, rhs);
+	}
+
+	uinteger_t& operator<<=(const uinteger_t& rhs) {
+		return bitwise_lshift(*this, rhs);
+	}
+
+	uinteger_t operator>>(const uinteger_t& rhs) const {
+		return bitwise_rshift(*this, rhs);
+	}
+
+	uinteger_t& operator>>=(const uinteger_t& rhs) {
+		return bitwise_rshift(*this, rhs);
+	}
+
+	// Logical Operators
+	bool operator!() const {
+		return !static_cast<bool>(*this);
+	}
+
+	bool operator&&(const uinteger_t& rhs) const {
+		return static_cast<bool>(*this) && rhs;
+	}
+
+	bool operator||(const uinteger_t& rhs) const {
+		return static_cast<bool>(*this) || rhs;
+	}
+
+	// Comparison Operators
+	bool operator==(const uinteger_t& rhs) const {
+		return compare(*this, rhs) == 0;
+	}
+
+	bool operator!=(const uinteger_t& rhs) const {
+		return compare(*this, rhs) != 0;
+	}
+
+	bool operator>(const uinteger_t& rhs) const {
+		return compare(*this, rhs) > 0;
+	}
+
+	bool operator<(const uinteger_t& rhs) const {
+		return compare(*this, rhs) < 0;
+	}
+
+	bool operator>=(const uinteger_t& rhs) const {
+		return compare(*this, rhs) >= 0;
+	}
+
+	bool operator<=(const uinteger_t& rhs) const {
+		return compare(*this, rhs) <= 0;
+	}
+
+	// Arithmetic Operators
+	uinteger_t operator+(const uinteger_t& rhs) const {
+		return add(*this, rhs);
+	}
+
+	uinteger_t& operator+=(const uinteger_t& rhs) {
+		return add(*this, rhs);
+	}
+
+	uinteger_t operator-(const uinteger_t& rhs) const {
+		return sub(*this, rhs);
+	}
+
+	uinteger_t& operator-=(const uinteger_t& rhs) {
+		return sub(*this, rhs);
+	}
+
+	uinteger_t operator*(const uinteger_t& rhs) const {
+		return mult(*this, rhs);
+	}
+
+	uinteger_t& operator*=(const uinteger_t& rhs) {
+		return mult(*this, rhs);
+	}
+
+	uinteger_t sqr() const {
+		return sqr(*this);
+	}
+
+	uinteger_t pow(std::size_t exp) const {
+		return pow(*this, exp);
+	}
+
+	std::pair<uinteger_t, uinteger_t> divmod(const uinteger_t& rhs) const {
+		return divmod(*this, rhs);
+	}
+
+	// Remainders by count single digit divisors, into remainders (of the
+	// same size), in a single pass and without allocating.
+	void mod_small(const digit* divisors, std::size_t count, digit* remainders) const {
+		mod_small(*this, divisors, count, remainders);
+	}
+
+	void mod_small(const std::vector<digit>& divisors, std::vector<digit>& remainders) const {
+		remainders.resize(divisors.size());
+		mod_small(*this, divisors.data(), divisors.size(), remainders.data());
+	}
+
+	// Reciprocal of this number, which can be reused for dividing by it
+	uinteger_t reciprocal() const {
+		return reciprocal(*this);
+	}
+
+	std::pair<uinteger_t, uinteger_t> reciprocal_divmod(const uinteger_t& rhs, const uinteger_t& reciprocal) const {
+		return reciprocal_divmod(*this, rhs, reciprocal);
+	}
+
+	uinteger_t powmod(const uinteger_t& exp, const uinteger_t& mod) const {
+		return powmod(*this, exp, mod);
+	}
+
+	uinteger_t powmod_sec(const uinteger_t& exp, const uinteger_t& mod) const {
+		return powmod_sec(*this, exp, mod);
+	}
+
+	uinteger_t gcd(const uinteger_t& rhs) const {
+		return gcd(*this, rhs);
+	}
+
+	uinteger_t lcm(const uinteger_t& rhs) const {
+		return lcm(*this, rhs);
+	}
+
+	std::tuple<uinteger_t, uinteger_t, uinteger_t> gcdext(const uinteger_t& rhs) const {
+		return gcdext(*this, rhs);
+	}
+
+	uinteger_t invmod(const uinteger_t& mod) const {
+		return invmod(*this, mod);
+	}
+
+	uinteger_t isqrt() const {
+		return isqrt(*this);
+	}
+
+	std::pair<uinteger_t, uinteger_t> isqrt_rem() const {
+		return isqrt_rem(*this);
+	}
+
+	uinteger_t iroot(std::size_t k) const {
+		return iroot(*this, k);
+	}
+
+	bool is_perfect_square() const {
+		return is_perfect_square(*this);
+	}
+
+	bool is_probable_prime(std::size_t rounds = 0) const {
+		return is_probable_prime(*this, rounds);
+	}
+
+	uinteger_t next_prime() const {
+		return next_prime(*this);
+	}
+
+	// Inverts count values modulo mod (in place), using a single modular
+	// inverse and three modular multiplications per value (Montgomery's trick).
+	static void batch_invmod(uinteger_t* values, std::size_t count, const uinteger_t& mod);
+
+	static void batch_invmod(std::vector<uinteger_t>& values, const uinteger_t& mod) {
+		batch_invmod(values.data(), values.size(), mod);
+	}
+
+	uinteger_t operator/(const uinteger_t& rhs) const {
+		return divmod(*this, rhs).first;
+	}
+
+	uinteger_t& operator/=(const uinteger_t& rhs) {
+		uinteger_t quotient(rhs.get_allocator());
+		uinteger_t remainder(rhs.get_allocator());
+		divmod(quotient, remainder, *this, rhs);
+		*this = std::move(quotient);
+		return *this;
+	}
+
+	uinteger_t operator%(const uinteger_t& rhs) const {
+		return divmod(*this, rhs).second;
+	}
+
+	uinteger_t& operator%=(const uinteger_t& rhs) {
+		uinteger_t quotient(rhs.get_allocator());
+		uinteger_t remainder(rhs.get_allocator());
+		divmod(quotient, remainder, *this, rhs);
+		*this = std::move(remainder);
+		return *this;
+	}
+
+	// Division by a divisor (a single digit, with its reciprocal), which
+	// only takes multiplications, and gets the remainder as a digit
+	std::pair<uinteger_t, digit> divmod(const divisor& rhs) const {
+		uinteger_t quotient(get_allocator());
+		auto remainder = divmod(quotient, *this, rhs);
+		return std::make_pair(std::move(quotient), remainder);
+	}
+
+	uinteger_t operator/(const divisor& rhs) const {
+		uinteger_t quotient(get_allocator());
+		divmod(quotient, *this, rhs);
+		return quotient;
+	}
+
+	uinteger_t& operator/=(const divisor& rhs) {
+		divmod(*this, *this, rhs);
+		return *this;
+	}
+
+	digit operator%(const divisor& rhs) const {
+		return mod(*this, rhs);
+	}
+
+	// Increment Operator
+	uinteger_t& operator++() {
+		return *this += uint_1();
+	}
+	uinteger_t operator++(int) {
+		uinteger_t temp(*this);
+		++*this;
+		return temp;
+	}
+
+	// Decrement Operator
+	uinteger_t& operator--() {
+		return *this -= uint_1();
+	}
+	uinteger_t operator--(int) {
+		uinteger_t temp(*this);
+		--*this;
+		return temp;
+	}
+
+	// Nothing done since promotion doesn't work here
+	uinteger_t operator+() const {
+		return *this;
+	}
+
+	// two's complement
+	uinteger_t operator-() const {
+		return uint_0() - *this;
+	}
+
+	// Get private value at index
+	const digit& value(std::size_t idx) const {
+		static const digit zero = 0;
+		return idx < size() ? *(begin() + idx) : zero;
+	}
+
+	// Get value of bit N
+	bool operator[](std::size_t n) const {
+		auto nd = n / digit_bits;
+		auto nm = n % digit_bits;
+		return nd < size() ? (*(begin() + nd) >> nm) & 1 : 0;
+	}
+
+	// Get bitsize of value
+	std::size_t bits() const {
+		auto sz = size();
+		if (sz) {
+			return _bits(back()) + (sz - 1) * digit_bits;
+		}
+		return 0;
+	}
+
+private:
+	// Biggest power of the base that fits in a digit (e.g. 10^19),
+	// and the number of digits (in that base) it has
+	static digit radix_chunk(int alphabet_base, std::size_t& chunk_digits) {
+		digit chunk = alphabet_base;
+		chunk_digits = 1;
+		while (chunk <= std::numeric_limits<digit>::max() / alphabet_base) {
+			chunk *= alphabet_base;
+			++chunk_digits;
+		}
+		return chunk;
+	}
+
+	using radix_power = std::shared_ptr<const uinteger_t>;
+
+	// Powers chunk^(2^level) of every base, shared by all conversions
+	struct radix_powers_cache {
+		std::mutex mutex;
+		std::vector<radix_power> powers[37];
+		std::size_t size = 0;  // in digits
+	};
+
+	static radix_powers_cache& radix_powers() {
+		static radix_powers_cache cache;
+		return cache;
+	}
+
+	// Appends the next power, chunk^(2^powers.size()), from the cache or by
+	// squaring the last one, keeping it while the cache has room for it.
+	static void push_radix_power(int alphabet_base, std::vector<radix_power>& powers) {
+		auto& cache = radix_powers();
+		auto level = powers.size();
+		{
+			std::lock_guard<std::mutex> lock(cache.mutex);
+			auto& cached = cache.powers[alphabet_base];
+			if (level < cached.size()) {
+				powers.push_back(cached[level]);
+				return;
+			}
+		}
+
+		radix_power power;
+		if (level) {
+			power = std::make_shared<const uinteger_t>(powers.back()->sqr());
+		} else {
+			std::size_t chunk_digits;
+			power = std::make_shared<const uinteger_t>(radix_chunk(alphabet_base, chunk_digits));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(cache.mutex);
+			auto& cached = cache.powers[alphabet_base];
+			if (level < cached.size()) {
+				// another thread got here first
+				power = cached[level];
+			} else if (level == cached.size() && cache.size + power->size() <= radix_powers_cache_size) {
+				cached.push_back(power);
+				cache.size += power->size();
+			}
+		}
+		powers.push_back(std::move(power));
+	}
+
+	// Divide and conquer conversion for str(), writes the chunk_digits * 2^k
+	// digits of num (less than powers[k] = chunk^(2^k)), starting from the
+	// least significant, by converting the quotient and remainder by
+	// powers[k - 1] (each half as long) or, when num gets small, by dividing
+	// off a chunk at a time.
+	template <typename It>
+	static void str_dc(It first, const uinteger_t& num, const std::vector<radix_power>& powers, std::size_t k, const divisor& chunk_divisor, const divisor& base_divisor, std::size_t chunk_digits) {
+		if (!k || num.size() <= str_dc_cutoff) {
+			uinteger_t quotient = num;
+			while (quotient) {
+				auto r = divmod(quotient, quotient, chunk_divisor);
+				for (std::size_t i = 0; i < chunk_digits; ++i) {
+					*first++ = chr(static_cast<int>(base_divisor.divmod(0, r, &r)));
+				}
+			}
+			return;
+		}
+
+		uinteger_t quotient(num.get_allocator()), remainder(num.get_allocator());
+		divmod(quotient, remainder, num, *powers[k - 1]);
+		str_dc(first, remainder, powers, k - 1, chunk_divisor, base_divisor, chunk_digits);
+		str_dc(first + (chunk_digits << (k - 1)), quotient, powers, k - 1, chunk_divisor, base_divisor, chunk_digits);
+	}
+
+	// Hex conversion of the n bytes at src (little endian, as the digits are
+	// stored) into 2 * n characters at dst, the most significant first.
+	static void hex_encode_scalar(char* dst, const unsigned char* src, std::size_t n) {
+		for (auto p = src + n; p != src; ) {
+			auto b = *--p;
+			*dst++ = "0123456789abcdef"[b >> 4];
+			*dst++ = "0123456789abcdef"[b & 0xf];
+		}
+	}
+
+	static int hex_ord(const char* c, const char* end) {
+		auto d = static_cast<unsigned>(static_cast<unsigned char>(*c) - '0');
+		if (d < 10) {
+			return static_cast<int>(d);
+		}
+		d = static_cast<unsigned>((static_cast<unsigned char>(*c) | 0x20) - 'a');
+		if (d < 6) {
+			return static_cast<int>(d + 10);
+		}
+		throw std::invalid_argument("Error: Not a digit in base 16: '" + std::string(1, *c) + "' at " + std::to_string(end - c));
+	}
+
+	// Hex conversion of the 2 * n characters at src (the most significant
+	// first) into the n bytes at dst; end is the end of the whole string.
+	static void hex_decode_scalar(unsigned char* dst, const char* src, std::size_t n, const char* end) {
+		for (auto q = dst + n; q != dst; src += 2) {
+			*--q = static_cast<unsigned char>((hex_ord(src, end) << 4) | hex_ord(src + 1, end));
+		}
+	}
+
+#if defined HAVE____BUILTIN_CPU_SUPPORTS
+	// The SIMD versions reverse the bytes of a block, split them into nibbles
+	// and look the characters up with a byte shuffle (or, decoding, validate
+	// the characters, map them to nibbles and join pairs with a multiply-add),
+	// leaving what doesn't fill a block to the narrower versions.
+	__attribute__((target("ssse3")))
+	static void hex_encode_ssse3(char* dst, const unsigned char* src, std::size_t n) {
+		const auto alphabet = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+		const auto reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const auto mask = _mm_set1_epi8(0x0f);
+		auto p = src + n;
+		for (; p - src >= 16; dst += 32) {
+			p -= 16;
+			auto x = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), reverse);
+			auto hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+			auto lo = _mm_and_si128(x, mask);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(alphabet, _mm_unpacklo_epi8(hi, lo)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_shuffle_epi8(alphabet, _mm_unpackhi_epi8(hi, lo)));
+		}
+		hex_encode_scalar(dst, src, p - src);
+	}
+
+	__attribute__((target("avx2")))
+	static void hex_encode_avx2(char* dst, const unsigned char* src, std::size_t n) {
+		const auto alphabet = _mm256_setr_epi8(
+			'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+			'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+		const auto reverse = _mm256_setr_epi8(
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const auto mask = _mm256_set1_epi8(0x0f);
+		auto p = src + n;
+		for (; p - src >= 32; dst += 64) {
+			p -= 32;
+			auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			x = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, reverse), 0x4e);
+			auto hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask);
+			auto lo = _mm256_and_si256(x, mask);
+			// (unpacking works by lanes, so the halves come out interleaved)
+			auto a = _mm256_shuffle_epi8(alphabet, _mm256_unpacklo_epi8(hi, lo));
+			auto b = _mm256_shuffle_epi8(alphabet, _mm256_unpackhi_epi8(hi, lo));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(a, b, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(a, b, 0x31));
+		}
+		hex_encode_ssse3(dst, src, p - src);
+	}
+
+	__attribute__((target("ssse3")))
+	static __m128i hex_nibbles_ssse3(__m128i v, bool& valid) {
+		auto d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+		auto a = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		auto is_d = _mm_cmpeq_epi8(_mm_subs_epu8(d, _mm_set1_epi8(9)), _mm_setzero_si128());
+		auto is_a = _mm_cmpeq_epi8(_mm_subs_epu8(a, _mm_set1_epi8(5)), _mm_setzero_si128());
+		valid &= _mm_movemask_epi8(_mm_or_si128(is_d, is_a)) == 0xffff;
+		return _mm_or_si128(_mm_and_si128(is_d, d), _mm_and_si128(is_a, _mm_add_epi8(a, _mm_set1_epi8(10))));
+	}
+
+	__attribute__((target("ssse3")))
+	static void hex_decode_ssse3(unsigned char* dst, const char* src, std::size_t n, const char* end) {
+		const auto reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const auto weights = _mm_set1_epi16(0x0110);
+		auto q = dst + n;
+		for (; q - dst >= 16; src += 32) {
+			q -= 16;
+			bool valid = true;
+			auto hi = hex_nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), valid);
+			auto lo = hex_nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)), valid);
+			if (!valid) {
+				hex_decode_scalar(q, src, 16, end);  // throws
+			}
+			auto x = _mm_packus_epi16(_mm_maddubs_epi16(hi, weights), _mm_maddubs_epi16(lo, weights));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(q), _mm_shuffle_epi8(x, reverse));
+		}
+		hex_decode_scalar(dst, src, q - dst, end);
+	}
+
+	__attribute__((target("avx2")))
+	static __m256i hex_nibbles_avx2(__m256i v, bool& valid) {
+		auto d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+		auto a = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+		auto is_d = _mm256_cmpeq_epi8(_mm256_subs_epu8(d, _mm256_set1_epi8(9)), _mm256_setzero_si256());
+		auto is_a = _mm256_cmpeq_epi8(_mm256_subs_epu8(a, _mm256_set1_epi8(5)), _mm256_setzero_si256());
+		valid &= _mm256_movemask_epi8(_mm256_or_si256(is_d, is_a)) == -1;
+		return _mm256_or_si256(_mm256_and_si256(is_d, d), _mm256_and_si256(is_a, _mm256_add_epi8(a, _mm256_set1_epi8(10))));
+	}
+
+	__attribute__((target("avx2")))
+	static void hex_decode_avx2(unsigned char* dst, const char* src, std::size_t n, const char* end) {
+		const auto reverse = _mm256_setr_epi8(
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		const auto weights = _mm256_set1_epi16(0x0110);
+		auto q = dst + n;
+		for (; q - dst >= 32; src += 64) {
+			q -= 32;
+			bool valid = true;
+			auto hi = hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), valid);
+			auto lo = hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)), valid);
+			if (!valid) {
+				hex_decode_scalar(q, src, 32, end);  // throws
+			}
+			// (packing works by lanes, so the quarters come out interleaved)
+			auto x = _mm256_packus_epi16(_mm256_maddubs_epi16(hi, weights), _mm256_maddubs_epi16(lo, weights));
+			x = _mm256_permute4x64_epi64(x, 0xd8);
+			x = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, reverse), 0x4e);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(q), x);
+		}
+		hex_decode_ssse3(dst, src, q - dst, end);
+	}
+
+	// 2 for AVX2, 1 for SSSE3 and 0 for neither
+	static int hex_simd() {
+		static const int level = (__builtin_cpu_init(),
+			__builtin_cpu_supports("avx2") ? 2 : __builtin_cpu_supports("ssse3") ? 1 : 0);
+		return level;
+	}
+#endif
+
+	static void hex_encode(char* dst, const unsigned char* src, std::size_t n) {
+#if defined HAVE____BUILTIN_CPU_SUPPORTS
+		switch (hex_simd()) {
+			case 2:
+				return hex_encode_avx2(dst, src, n);
+			case 1:
+				return hex_encode_ssse3(dst, src, n);
+		}
+#endif
+		hex_encode_scalar(dst, src, n);
+	}
+
+	static void hex_decode(unsigned char* dst, const char* src, std::size_t n, const char* end) {
+#if defined HAVE____BUILTIN_CPU_SUPPORTS
+		switch (hex_simd()) {
+			case 2:
+				return hex_decode_avx2(dst, src, n, end);
+			case 1:
+				return hex_decode_ssse3(dst, src, n, end);
+		}
+#endif
+		hex_decode_scalar(dst, src, n, end);
+	}
+
+public:
+	// Get string representation of value
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result str(int alphabet_base = 10) const {
+		auto num_sz = size();
+		if (alphabet_base >= 2 && alphabet_base <= 36) {
+			Result result;
+			if (num_sz && alphabet_base == 16 && sizeof(typename Result::value_type) == 1) {
+				// The most significant digit without its leading zeros, then
+				// the bytes of all the others straight from the digits:
+				auto top = back();
+				auto top_chars = static_cast<std::size_t>((_bits(top) + 3) / 4);
+				result.resize(top_chars + (num_sz - 1) * digit_octets * 2);
+				auto ptr = reinterpret_cast<char*>(&result[0]);
+				for (auto i = top_chars; i; top >>= 4) {
+					ptr[--i] = chr(static_cast<int>(top & 0xf));
+				}
+				hex_encode(ptr + top_chars, reinterpret_cast<const unsigned char*>(data()), (num_sz - 1) * digit_octets);
+			} else if (num_sz) {
+				auto alphabet_base_bits = base_bits(alphabet_base);
+				result.reserve(num_sz * base_size(alphabet_base));
+				if (alphabet_base_bits) {
+					digit alphabet_base_mask = alphabet_base - 1;
+					std::size_t shift = 0;
+					auto ptr = reinterpret_cast<const half_digit*>(data());
+					digit v = *ptr++;
+					v <<= half_digit_bits;
+					for (auto i = num_sz * 2 - 1; i; --i) {
+						v >>= half_digit_bits;
+						v |= (static_cast<digit>(*ptr++) << half_digit_bits);
+						do {
+							auto d = static_cast<int>((v >> shift) & alphabet_base_mask);
+							result.push_back(chr(d));
+							shift += alphabet_base_bits;
+						} while (shift <= half_digit_bits);
+						shift -= half_digit_bits;
+					}
+					v >>= (shift + half_digit_bits);
+					while (v) {
+						auto d = static_cast<int>(v & alphabet_base_mask);
+						result.push_back(chr(d));
+						v >>= alphabet_base_bits;
+					}
+				} else {
+					// Divides by the biggest power of the base that fits in a digit
+					// (e.g. 10^19), using its reciprocal, and splits the remainders,
+					// after splitting big numbers by powers of that, recursively:
+					std::size_t chunk_digits;
+					const divisor chunk_divisor(radix_chunk(alphabet_base, chunk_digits));
+					const divisor base_divisor(alphabet_base);
+					std::vector<radix_power> powers;
+					std::size_t k = 0;
+					if (num_sz > str_dc_cutoff) {
+						do {
+							push_radix_power(alphabet_base, powers);
+						} while (compare(*powers.back(), *this) <= 0);
+						k = powers.size() - 1;
+						result.resize(chunk_digits << k, chr(0));
+					} else {
+						// chunks have more than 58 bits, so there are at most 9 for every 8 digits
+						result.resize(chunk_digits * (num_sz + num_sz / 8 + 1), chr(0));
+					}
+					str_dc(result.begin(), *this, powers, k, chunk_divisor, base_divisor, chunk_digits);
+				}
+				auto s = chr(0);
+				auto rit_f = std::find_if(result.rbegin(), result.rend(), [s](const char& c) { return c != s; });
+				result.resize(result.rend() - rit_f); // shrink
+				std::reverse(result.begin(), result.end());
+			} else {
+				result.push_back(chr(0));
+			}
+			return result;
+		} else if (alphabet_base == 256) {
+			if (num_sz) {
+				auto ptr = reinterpret_cast<const char*>(data());
+				Result result(ptr, ptr + num_sz * digit_octets);
+				auto rit_f = std::find_if(result.rbegin(), result.rend(), [](const char& c) { return c; });
+				result.resize(result.rend() - rit_f); // shrink
+				std::reverse(result.begin(), result.end());
+				return result;
+			} else {
+				Result result;
+				result.push_back('\x00');
+				return result;
+			}
+		} else {
+			throw std::invalid_argument("Base must be in the range [2, 36]");
+		}
+	}
+
+	// Results of to_chars() and from_chars(), as those of std::to_chars()
+	// and std::from_chars()
+	struct to_chars_result {
+		char* ptr;
+		std::errc ec;
+	};
+
+	struct from_chars_result {
+		const char* ptr;
+		std::errc ec;
+	};
+
+	// Most characters the value can take in alphabet_base (exact for powers
+	// of two), for sizing the buffers given to to_chars()
+	std::size_t max_chars(int alphabet_base = 10) const {
+		if (alphabet_base < 2 || alphabet_base > 36) {
+			return 0;
+		}
+		auto num_bits = bits();
+		if (!num_bits) {
+			return 1;
+		}
+		auto alphabet_base_bits = base_bits(alphabet_base);
+		if (alphabet_base_bits) {
+			return (num_bits + alphabet_base_bits - 1) / alphabet_base_bits;
+		}
+		return static_cast<std::size_t>(std::ceil(num_bits / std::log2(alphabet_base))) + 1;
+	}
+
+	// Writes the value in alphabet_base into [first, last), as std::to_chars()
+	// does: returns the end of the characters written, or last and
+	// std::errc::value_too_large if they don't fit (the rest of the buffer
+	// can be used as scratch space). It never throws, and only
+	// allocates (for the temporaries of the divide and conquer conversion) for
+	// numbers bigger than STR_DC_CUTOFF bits in bases other than powers of two.
+	to_chars_result to_chars(char* first, char* last, int alphabet_base = 10) const noexcept {
+		if (alphabet_base < 2 || alphabet_base > 36) {
+			return {first, std::errc::invalid_argument};
+		}
+		auto num_sz = size();
+		auto space = static_cast<std::size_t>(last - first);
+		if (!num_sz) {
+			if (!space) {
+				return {last, std::errc::value_too_large};
+			}
+			*first = chr(0);
+			return {first + 1, std::errc()};
+		}
+
+		auto alphabet_base_bits = base_bits(alphabet_base);
+		if (alphabet_base_bits) {
+			auto chars = max_chars(alphabet_base);
+			if (chars > space) {
+				return {last, std::errc::value_too_large};
+			}
+			if (alphabet_base == 16) {
+				auto top_chars = chars - (num_sz - 1) * digit_octets * 2;
+				auto top = back();
+				for (auto i = top_chars; i; top >>= 4) {
+					first[--i] = chr(static_cast<int>(top & 0xf));
+				}
+				hex_encode(first + top_chars, reinterpret_cast<const unsigned char*>(data()), (num_sz - 1) * digit_octets);
+			} else {
+				digit alphabet_base_mask = alphabet_base - 1;
+				auto ptr = data();
+				for (std::size_t i = 0, pos = 0; i < chars; ++i, pos += alphabet_base_bits) {
+					auto idx = pos / digit_bits;
+					auto shift = pos % digit_bits;
+					auto v = ptr[idx] >> shift;
+					if (shift + alphabet_base_bits > digit_bits && idx + 1 < num_sz) {
+						v |= ptr[idx + 1] << (digit_bits - shift);
+					}
+					first[chars - 1 - i] = chr(static_cast<int>(v & alphabet_base_mask));
+				}
+			}
+			return {first + chars, std::errc()};
+		}
+
+		if (num_sz > str_dc_cutoff) {
+			try {
+				auto result = str(alphabet_base);
+				if (result.size() > space) {
+					return {last, std::errc::value_too_large};
+				}
+				return {std::copy(result.begin(), result.end(), first), std::errc()};
+			} catch (...) {
+				return {first, std::errc::not_enough_memory};
+			}
+		}
+
+		// Divides a copy of the digits (on the stack) by the biggest power of
+		// the base that fits in a digit, writing the chunks of characters
+		// backwards from last, and then moves them to first:
+		digit quotient[str_dc_cutoff + 1];
+		std::copy(begin(), end(), quotient);
+		std::size_t chunk_digits;
+		const divisor chunk_divisor(radix_chunk(alphabet_base, chunk_digits));
+		const divisor base_divisor(alphabet_base);
+		auto ptr = last;
+		while (num_sz) {
+			digit r = 0;
+			for (auto i = num_sz; i--; ) {
+				r = chunk_divisor.divmod(r, quotient[i], &quotient[i]);
+			}
+			if (!quotient[num_sz - 1]) {
+				--num_sz;
+			}
+			// (the last chunk goes without its leading zeros)
+			for (std::size_t i = 0; i < chunk_digits && (num_sz || r); ++i) {
+				if (ptr == first) {
+					return {last, std::errc::value_too_large};
+				}
+				*--ptr = chr(static_cast<int>(base_divisor.divmod(0, r, &r)));
+			}
+		}
+		return {std::copy(ptr, last, first), std::errc()};
+	}
+
+private:
+	// Divide and conquer parsing for strtouint(), of the digits in [first,
+	// last) (end is the end of the whole string, for errors), by parsing the
+	// last chunk_digits * 2^k digits and the ones before them, multiplying
+	// these by powers[k] = chunk^(2^k) or, when there are few digits left, by
+	// multiplying by chunk and adding a chunk of digits at a time.
+	static void strtouint_dc(uinteger_t& result, const char* first, const char* last, const char* end, int alphabet_base, const std::vector<radix_power>& powers, digit chunk, std::size_t chunk_digits) {
+		auto chunks = (static_cast<std::size_t>(last - first) + chunk_digits - 1) / chunk_digits;
+		if (chunks <= strtouint_dc_cutoff || powers.size() <= 1) {
+			auto next = first + (last - first - 1) % chunk_digits + 1;
+			// (the first chunk can be shorter, but result is still empty then)
+			for (; first != last; next += chunk_digits) {
+				digit carry = 0;
+				for (; first != next; ++first) {
+					auto d = ord(static_cast<unsigned char>(*first));
+					if (d < 0) {
+						throw std::invalid_argument("Error: Not a digit in base " + std::to_string(alphabet_base) + ": '" + std::string(1, *first) + "' at " + std::to_string(end - first));
+					}
+					carry = carry * alphabet_base + d;
+				}
+				for (auto it = result.begin(); it != result.end(); ++it) {
+					carry = _multadd(*it, chunk, 0, carry, &*it);
+				}
+				if (carry) {
+					result.append(carry);
+				}
+			}
+			return;
+		}
+
+		std::size_t k = 0;
+		while (k + 1 < powers.size() && (static_cast<std::size_t>(2) << k) < chunks) {
+			++k;
+		}
+		auto middle = last - (chunk_digits << k);
+		uinteger_t low(result.get_allocator());
+		strtouint_dc(result, first, middle, end, alphabet_base, powers, chunk, chunk_digits);
+		strtouint_dc(low, middle, last, end, alphabet_base, powers, chunk, chunk_digits);
+		result *= *powers[k];
+		result += low;
+	}
+
+public:
+	// Frees the powers of the bases cached by the conversions
+	static void clear_radix_powers() {
+		auto& cache = radix_powers();
+		std::lock_guard<std::mutex> lock(cache.mutex);
+		for (auto& cached : cache.powers) {
+			cached.clear();
+		}
+		cache.size = 0;
+	}
+
+	static uinteger_t strtouint(const void* encoded, std::size_t encoded_size, int alphabet_base) {
+		uinteger_t result;
+		strtouint(result, static_cast<const char*>(encoded), encoded_size, alphabet_base);
+		return result;
+	}
+
+private:
+	// Parses into an empty result, growing its digits in place
+	static void strtouint(uinteger_t& result, const char* data, std::size_t encoded_size, int alphabet_base) {
+		if (alphabet_base >= 2 && alphabet_base <= 36) {
+			auto alphabet_base_bits = base_bits(alphabet_base);
+			if (alphabet_base == 16) {
+				// The characters before the last whole digits make the most
+				// significant digit, the rest are decoded straight into bytes:
+				auto end = data + encoded_size;
+				auto digit_chars = digit_octets * 2;
+				auto head = encoded_size % digit_chars;
+				result.resize(encoded_size / digit_chars + (head ? 1 : 0));
+				if (head) {
+					digit top = 0;
+					for (; head; --head, ++data) {
+						top = (top << 4) | static_cast<digit>(hex_ord(data, end));
+					}
+					result.back() = top;
+				}
+				hex_decode(reinterpret_cast<unsigned char*>(result.data()), data, (end - data) / 2, end);
+				result.trim();
+			} else if (alphabet_base_bits) {
+				// Checks all the characters, then puts the bits of each one in
+				// place, starting from the least significant:
+				auto end = data + encoded_size;
+				for (auto ptr = data; ptr != end; ++ptr) {
+					auto d = ord(static_cast<unsigned char>(*ptr));
+					if (d < 0 || d >= alphabet_base) {
+						throw std::invalid_argument("Error: Not a digit in base " + std::to_string(alphabet_base) + ": '" + std::string(1, *ptr) + "' at " + std::to_string(end - ptr));
+					}
+				}
+				auto bits = static_cast<std::size_t>(alphabet_base_bits);
+				result.resize((encoded_size * bits + digit_bits - 1) / digit_bits);
+				std::fill(result.begin(), result.end(), 0);
+				auto it = result.begin();
+				std::size_t shift = 0;
+				for (auto ptr = end; ptr != data; ) {
+					auto d = static_cast<digit>(ord(static_cast<unsigned char>(*--ptr)));
+					*it |= d << shift;
+					shift += bits;
+					if (shift >= digit_bits) {
+						shift -= digit_bits;
+						if (++it == result.end()) {
+							break;
+						}
+						if (shift) {
+							*it = d >> (bits - shift);
+						}
+					}
+				}
+				result.trim();
+			} else {
+				// Parses as many digits as fit in a digit at a time (e.g. 19 in base
+				// 10), combining the halves of long strings by powers of that:
+				std::size_t chunk_digits;
+				auto chunk = radix_chunk(alphabet_base, chunk_digits);
+				auto chunks = (encoded_size + chunk_digits - 1) / chunk_digits;
+				std::vector<radix_power> powers;
+				if (chunks > strtouint_dc_cutoff) {
+					do {
+						push_radix_power(alphabet_base, powers);
+					} while ((static_cast<std::size_t>(1) << powers.size()) < chunks);
+				}
+				strtouint_dc(result, data, data + encoded_size, data + encoded_size, alphabet_base, powers, chunk, chunk_digits);
+			}
+		} else if (encoded_size && alphabet_base == 256) {
+			auto value_size = encoded_size / digit_octets;
+			auto value_padding = encoded_size % digit_octets;
+			if (value_padding) {
+				value_padding = digit_octets - value_padding;
+				++value_size;
+			}
+			result.resize(value_size); // grow (no initialization)
+			*result.begin() = 0; // initialize value
+			auto ptr = reinterpret_cast<char*>(result.data());
+			std::copy(data, data + encoded_size, ptr + value_padding);
+			std::reverse(ptr, ptr + value_size * digit_octets);
+		} else {
+			throw std::invalid_argument("Error: Cannot convert from base " + std::to_string(alphabet_base));
+		}
+	}
+
+public:
+
+	// Parses the longest run of digits in alphabet_base at the start of
+	// [first, last) into value, as std::from_chars() does: returns the end of
+	// the run, or first and std::errc::invalid_argument if there is none. It
+	// never throws, and on errors (std::errc::not_enough_memory too) leaves
+	// value alone, so it parses into a number of its own (with the allocator
+	// of value), which only allocates for numbers that don't fit in the small
+	// buffer and for the temporaries of the divide and conquer parsing.
+	static from_chars_result from_chars(const char* first, const char* last, uinteger_t& value, int alphabet_base = 10) noexcept {
+		if (alphabet_base < 2 || alphabet_base > 36) {
+			return {first, std::errc::invalid_argument};
+		}
+		auto ptr = first;
+		for (; ptr != last; ++ptr) {
+			auto d = ord(static_cast<unsigned char>(*ptr));
+			if (d < 0 || d >= alphabet_base) {
+				break;
+			}
+		}
+		if (ptr == first) {
+			return {first, std::errc::invalid_argument};
+		}
+		try {
+			uinteger_t parsed(value.get_allocator());
+			strtouint(parsed, first, static_cast<std::size_t>(ptr - first), alphabet_base);
+			value = std::move(parsed);
+		} catch (...) {
+			return {first, std::errc::not_enough_memory};
+		}
+		return {ptr, std::errc()};
+	}
+
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result bin() const {
+		return str<Result>(2);
+	}
+
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result oct() const {
+		return str<Result>(8);
+	}
+
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result hex() const {
+		return str<Result>(16);
+	}
+
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result raw() const {
+		return str<Result>(256);
+	}
+};
+
+namespace std {  // This is probably not a good idea
+	// Make it work with std::string()
+	template <typename Alloc>
+	inline std::string to_string(basic_uinteger_t<Alloc>& num) {
+		return num.str();
+	}
+	template <typename Alloc>
+	inline const std::string to_string(const basic_uinteger_t<Alloc>& num) {
+		return num.str();
+	}
+}
+
+// lhs type T as first arguemnt
+// If the output is not a bool, casts to type T
+
+// Bitwise Operators
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator&(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) & rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator&=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(rhs & lhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator|(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) | rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator|=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(rhs | lhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator^(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) ^ rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator^=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(rhs ^ lhs);
+}
+
+// Bitshift operators
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+inline basic_uinteger_t<Alloc> operator<<(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) << rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator<<=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(lhs << rhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+inline basic_uinteger_t<Alloc> operator>>(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) >> rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator>>=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(lhs >> rhs);
+}
+
+// Comparison Operators
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator==(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) == rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator!=(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) != rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator>(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) > rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator<(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) < rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator>=(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) >= rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+bool operator<=(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) <= rhs;
+}
+
+// Arithmetic Operators
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator+(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) + rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator+=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(rhs + lhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator-(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) - rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator-=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(lhs - rhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator*(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) * rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator*=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(rhs * lhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator/(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) / rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator/=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(lhs / rhs);
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+basic_uinteger_t<Alloc> operator%(const T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return basic_uinteger_t<Alloc>(lhs) % rhs;
+}
+
+template <typename T, typename Alloc, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<basic_uinteger_t<Alloc>>>::value>>
+T& operator%=(T& lhs, const basic_uinteger_t<Alloc>& rhs) {
+	return lhs = static_cast<T>(lhs % rhs);
+}
+
+// IO Operator
+template <typename Alloc>
+inline std::ostream& operator<<(std::ostream& stream, const basic_uinteger_t<Alloc>& rhs) {
+	if (stream.flags() & stream.oct) {
+		stream << rhs.str(8);
+	} else if (stream.flags() & stream.dec) {
+		stream << rhs.str(10);
+	} else if (stream.flags() & stream.hex) {
+		stream << rhs.str(16);
+	}
+	return stream;
+}
+
+// Montgomery context
+//
+// Modular multiplication by an odd modulus N, of numbers in Montgomery form
+// (x * R mod N, with R = B^n, for the n digits of N). Instead of dividing by N,
+// each product gets a multiple of N added so that its lowest n digits become
+// zero and are dropped (dividing by R), so no divisions are needed after the
+// context (the inverse of N modulo the digit base and R^2 mod N) is set up.
+// Arguments in Montgomery form must be less than N.
+template <typename Alloc>
+class basic_montgomery_context {
+	using uinteger_t = basic_uinteger_t<Alloc>;
+
+	using digit = typename uinteger_t::digit;
+
+	uinteger_t _modulus;
+	digit _ninv;       // -N^-1 modulo the digit base
+	uinteger_t _one;   // R mod N (one, in Montgomery form)
+	uinteger_t _r2;    // R^2 mod N (to convert into Montgomery form)
+
+	// Subtracts N if needed, after a reduction
+	uinteger_t& _finish(uinteger_t& result) const {
+		result.trim();
+		if (uinteger_t::compare(result, _modulus) >= 0) {
+			uinteger_t::sub(result, _modulus);
+		}
+		return result;
+	}
+
+	// Montgomery multiplication of zero padded numbers of n digits, in constant
+	// time (no branches or memory accesses depend on the values), r must not be
+	// a or b, and t is scratch space of n + 2 digits.
+	void _mont_mul_sec(digit* r, const digit* a, const digit* b, digit* t) const {
+		auto n = _modulus.size();
+		auto modulus = _modulus.data();
+
+		std::fill(t, t + n + 2, 0);
+		for (std::size_t i = 0; i < n; ++i) {
+			// t += a * b[i]
+			digit carry = 0;
+			for (std::size_t j = 0; j < n; ++j) {
+				carry = uinteger_t::_multadd(a[j], b[i], t[j], carry, &t[j]);
+			}
+			t[n + 1] = uinteger_t::_addcarry(t[n], carry, 0, &t[n]);
+
+			// t = (t + m * N) / B, with m such that the lowest digit becomes zero
+			digit m = t[0] * _ninv;
+			digit lo;
+			carry = uinteger_t::_multadd(m, modulus[0], t[0], 0, &lo);
+			for (std::size_t j = 1; j < n; ++j) {
+				carry = uinteger_t::_multadd(m, modulus[j], t[j], carry, &t[j - 1]);
+			}
+			carry = uinteger_t::_addcarry(t[n], carry, 0, &t[n - 1]);
+			t[n] = t[n + 1] + carry;
+		}
+
+		// r = t - N, unless that borrows (then r = t):
+		digit borrow = 0;
+		for (std::size_t j = 0; j < n; ++j) {
+			borrow = uinteger_t::_subborrow(t[j], modulus[j], borrow, &r[j]);
+		}
+		digit lo;
+		borrow = uinteger_t::_subborrow(t[n], 0, borrow, &lo);
+		digit mask = 0 - borrow;
+		for (std::size_t j = 0; j < n; ++j) {
+			r[j] = (t[j] & mask) | (r[j] & ~mask);
+		}
+	}
+
+public:
+	explicit basic_montgomery_context(const uinteger_t& modulus) :
+		_modulus(modulus),
+		_one(modulus.get_allocator()),
+		_r2(modulus.get_allocator()) {
+		if (!_modulus || !(_modulus.front() & 1)) {
+			throw std::invalid_argument("Error: Montgomery modulus must be odd");
+		}
+		_ninv = 0 - uinteger_t::_inverse(_modulus.front());
+
+		auto bits = _modulus.size() * uinteger_t::digit_bits;
+		_one = (uinteger_t::uint_1(_modulus.get_allocator()) << bits) % _modulus;
+		_r2 = (uinteger_t::uint_1(_modulus.get_allocator()) << (2 * bits)) % _modulus;
+	}
+
+	const uinteger_t& modulus() const {
+		return _modulus;
+	}
+
+	const uinteger_t& one() const {
+		return _one;
+	}
+
+	// Montgomery reduction, in place: x / R mod N (for x < N * R)
+	uinteger_t& redc(uinteger_t& x) const {
+		auto n = _modulus.size();
+		auto modulus = _modulus.data();
+		auto x_sz = x.size();
+		assert(x_sz <= 2 * n);
+
+		x.resize(2 * n + 1);
+		std::fill(x.begin() + x_sz, x.end(), 0);
+		auto r = x.data();
+
+		digit carry2 = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			// r += m * N * B^i, with m such that the i-th digit becomes zero
+			digit m = r[i] * _ninv;
+			digit carry = 0;
+			for (std::size_t j = 0; j < n; ++j) {
+				carry = uinteger_t::_multadd(m, modulus[j], r[i + j], carry, &r[i + j]);
+			}
+			carry2 = uinteger_t::_addcarry(r[i + n], carry, carry2, &r[i + n]);
+		}
+		r[2 * n] = carry2;
+
+		// Drop the lowest n digits:
+		std::copy(x.begin() + n, x.end(), x.begin());
+		x.resize(n + 1);
+		return _finish(x);
+	}
+
+	// Montgomery reduction: x / R mod N (for x < N * R)
+	uinteger_t& redc(uinteger_t& result, const uinteger_t& x) const {
+		if (&result != &x) {
+			result = x;
+		}
+		return redc(result);
+	}
+
+	uinteger_t redc(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		redc(result, x);
+		return result;
+	}
+
+	// Montgomery multiplication: lhs * rhs / R mod N
+	// Using Coarsely Integrated Operand Scanning (multiplying by one digit
+	// of rhs and reducing by one digit, in turns) for moduli of up to
+	// the Karatsuba cutoff, after which multiplying first pays off.
+	// For big moduli, the product goes in tmp (a buffer for the caller to
+	// reuse), which is then reduced in place and swapped into the result.
+	uinteger_t& mont_mul(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, uinteger_t& tmp) const {
+		auto n = _modulus.size();
+		if (n > uinteger_t::karatsuba_cutoff) {
+			uinteger_t::mult(tmp, lhs, rhs);
+			redc(tmp);
+			std::swap(result, tmp);
+			return result;
+		}
+
+		auto modulus = _modulus.data();
+		auto a = lhs.data();
+		auto a_sz = lhs.size();
+		auto b = rhs.data();
+		auto b_sz = rhs.size();
+		assert(a_sz <= n && b_sz <= n);
+
+		// Works in the result, unless it's also one of the arguments:
+		uinteger_t t(_modulus.get_allocator());
+		auto& acc = &result == &lhs || &result == &rhs ? t : result;
+		acc.resize(n + 2);
+		std::fill(acc.begin(), acc.end(), 0);
+		auto r = acc.data();
+
+		for (std::size_t i = 0; i < n; ++i) {
+			digit carry = 0;
+
+			// r += a * b[i]
+			if (i < b_sz) {
+				auto bi = b[i];
+				std::size_t j = 0;
+				for (; j < a_sz; ++j) {
+					carry = uinteger_t::_multadd(a[j], bi, r[j], carry, &r[j]);
+				}
+				for (; carry && j <= n; ++j) {
+					carry = uinteger_t::_addcarry(r[j], carry, 0, &r[j]);
+				}
+				r[n + 1] += carry;
+			}
+
+			// r = (r + m * N) / B, with m such that the lowest digit becomes zero
+			digit m = r[0] * _ninv;
+			digit lo;
+			carry = uinteger_t::_multadd(m, modulus[0], r[0], 0, &lo);
+			for (std::size_t j = 1; j < n; ++j) {
+				carry = uinteger_t::_multadd(m, modulus[j], r[j], carry, &r[j - 1]);
+			}
+			carry = uinteger_t::_addcarry(r[n], carry, 0, &r[n - 1]);
+			r[n] = r[n + 1] + carry;
+			r[n + 1] = 0;
+		}
+
+		if (&acc == &t) {
+			result = std::move(t);
+		}
+		return _finish(result);
+	}
+
+	uinteger_t& mont_mul(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) const {
+		uinteger_t tmp(_modulus.get_allocator());
+		return mont_mul(result, lhs, rhs, tmp);
+	}
+
+	uinteger_t mont_mul(const uinteger_t& lhs, const uinteger_t& rhs) const {
+		uinteger_t result(_modulus.get_allocator());
+		mont_mul(result, lhs, rhs);
+		return result;
+	}
+
+	// Montgomery squaring: x * x / R mod N
+	// (squares first, as squaring only needs the cross products once, into
+	// tmp, which is then reduced in place and swapped into the result)
+	uinteger_t& mont_sqr(uinteger_t& result, const uinteger_t& x, uinteger_t& tmp) const {
+		uinteger_t::sqr(tmp, x);
+		redc(tmp);
+		std::swap(result, tmp);
+		return result;
+	}
+
+	uinteger_t& mont_sqr(uinteger_t& result, const uinteger_t& x) const {
+		uinteger_t tmp(_modulus.get_allocator());
+		return mont_sqr(result, x, tmp);
+	}
+
+	uinteger_t mont_sqr(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		mont_sqr(result, x);
+		return result;
+	}
+
+	// Converts into Montgomery form: x * R mod N
+	uinteger_t& to_mont(uinteger_t& result, const uinteger_t& x) const {
+		if (uinteger_t::compare(x, _modulus) >= 0) {
+			return mont_mul(result, x % _modulus, _r2);
+		}
+		return mont_mul(result, x, _r2);
+	}
+
+	uinteger_t to_mont(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		to_mont(result, x);
+		return result;
+	}
+
+	// Converts back from Montgomery form: x / R mod N
+	uinteger_t& from_mont(uinteger_t& result, const uinteger_t& x) const {
+		return redc(result, x);
+	}
+
+	uinteger_t from_mont(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		from_mont(result, x);
+		return result;
 	}
 
-private:
-	// Constructors
+	// Modular exponentiation: base^exp mod N
+	uinteger_t& pow(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp) const {
+		if (!exp) {
+			return from_mont(result, _one);
+		}
 
-	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-	void _uint_t(const T& value) {
-		append(static_cast<digit>(value));
+		// (all the products and squares go through the same buffer)
+		uinteger_t x(_modulus.get_allocator());
+		uinteger_t tmp(_modulus.get_allocator());
+		to_mont(x, base);
+		uinteger_t::sliding_window_pow(x, x, exp,
+			[this, &tmp](uinteger_t& r, const uinteger_t& lhs, const uinteger_t& rhs) { mont_mul(r, lhs, rhs, tmp); },
+			[this, &tmp](uinteger_t& r, const uinteger_t& a) { mont_sqr(r, a, tmp); });
+		return from_mont(result, x);
 	}
 
-	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-	void _uint_t(const T& value, Args... args) {
-		_uint_t(args...);
-		append(static_cast<digit>(value));
+	uinteger_t pow(const uinteger_t& base, const uinteger_t& exp) const {
+		uinteger_t result(_modulus.get_allocator());
+		pow(result, base, exp);
+		return result;
 	}
 
-	// This constructor creates a window view of the _value
-	uinteger_t(const uinteger_t& o, std::size_t begin, std::size_t end) :
-		_begin(begin),
-		_end(end),
-		_value(o._value),
-		_carry(o._carry) { }
+	// Constant time modular exponentiation: base^exp mod N
+	// Fixed window exponentiation (four bits at a time, always multiplying),
+	// selecting from the table of powers by masking every entry, so nothing
+	// about exp but its number of digits is revealed (base is not protected).
+	uinteger_t& pow_sec(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp) const {
+		constexpr std::size_t window_bits = 4;
+		constexpr std::size_t window_size = 1 << window_bits;
+		static_assert(uinteger_t::digit_bits % window_bits == 0, "windows must not straddle digits");
+
+		auto n = _modulus.size();
+
+		// Table of base^0 .. base^15, in Montgomery form (zero padded to n digits):
+		std::vector<digit> table(window_size * n, 0);
+		std::copy(_one.begin(), _one.end(), table.begin());
+		auto x = to_mont(base);
+		std::copy(x.begin(), x.end(), table.begin() + n);
+
+		std::vector<digit> acc(table.begin(), table.begin() + n);
+		std::vector<digit> tmp(n);
+		std::vector<digit> sel(n);
+		std::vector<digit> t(n + 2);
+		for (std::size_t i = 2; i < window_size; ++i) {
+			_mont_mul_sec(&table[i * n], &table[(i - 1) * n], &table[n], t.data());
+		}
 
-public:
-	uinteger_t() :
-		_begin(0),
-		_end(0),
-		_value(_value_instance),
-		_carry(false) { }
+		auto e = exp.data();
+		for (auto i = exp.size() * uinteger_t::digit_bits; i; i -= window_bits) {
+			for (std::size_t j = 0; j < window_bits; ++j) {
+				_mont_mul_sec(tmp.data(), acc.data(), acc.data(), t.data());
+				acc.swap(tmp);
+			}
 
-	uinteger_t(const uinteger_t& o) :
-		_begin(0),
-		_end(0),
-		_value_instance(o.begin(), o.end()),
-		_value(_value_instance),
-		_carry(o._carry) { }
+			auto w = (e[(i - window_bits) / uinteger_t::digit_bits] >> ((i - window_bits) % uinteger_t::digit_bits)) & (window_size - 1);
+			std::fill(sel.begin(), sel.end(), 0);
+			for (std::size_t k = 0; k < window_size; ++k) {
+				digit mask = 0 - (((k ^ w) - 1) >> (uinteger_t::digit_bits - 1));  // all ones if k == w
+				for (std::size_t j = 0; j < n; ++j) {
+					sel[j] |= table[k * n + j] & mask;
+				}
+			}
+			_mont_mul_sec(tmp.data(), acc.data(), sel.data(), t.data());
+			acc.swap(tmp);
+		}
 
-	uinteger_t(uinteger_t&& o) :
-		_begin(std::move(o._begin)),
-		_end(std::move(o._end)),
-		_value_instance(std::move(o._value_instance)),
-		_value(_value_instance),
-		_carry(std::move(o._carry)) { }
+		// Convert back from Montgomery form (multiplying by one):
+		std::fill(sel.begin(), sel.end(), 0);
+		sel[0] = 1;
+		_mont_mul_sec(tmp.data(), acc.data(), sel.data(), t.data());
 
-	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-	uinteger_t(const T& value) :
-		_begin(0),
-		_end(0),
-		_value(_value_instance),
-		_carry(false) {
-		if (value) {
-			append(static_cast<digit>(value));
-		}
+		result.resize(n);
+		std::copy(tmp.begin(), tmp.end(), result.begin());
+		result.trim();
+		return result;
 	}
 
-	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-	uinteger_t(const T& value, Args... args) :
-		_begin(0),
-		_end(0),
-		_value(_value_instance),
-		_carry(false) {
-		_uint_t(args...);
-		append(static_cast<digit>(value));
-		trim();
+	uinteger_t pow_sec(const uinteger_t& base, const uinteger_t& exp) const {
+		uinteger_t result(_modulus.get_allocator());
+		pow_sec(result, base, exp);
+		return result;
 	}
+};
 
-	template <typename T, typename... Args, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-	uinteger_t(std::initializer_list<T> list) :
-		_begin(0),
-		_end(0),
-		_value(_value_instance),
-		_carry(false) {
-		reserve(list.size());
-		for (const auto& value : list) {
-			append(static_cast<digit>(value));
+// Barrett context
+//
+// Reduction modulo any (non zero) modulus m, of n digits, using a reciprocal
+// calculated once: mu = floor(B^(2n) / m). For x < B^(2n), the quotient is
+// estimated as ((x / B^(n-1)) * mu) / B^(n+1), which only needs the top digits
+// of the product and falls short by at most a few units, so the remainder only
+// needs the lowest n+1 digits of the estimated quotient times m.
+template <typename Alloc>
+class basic_barrett_context {
+	using uinteger_t = basic_uinteger_t<Alloc>;
+
+	uinteger_t _modulus;
+	uinteger_t _mu;    // floor(B^(2n) / m)
+
+public:
+	explicit basic_barrett_context(const uinteger_t& modulus) :
+		_modulus(modulus),
+		_mu(modulus.get_allocator()) {
+		if (!_modulus) {
+			throw std::domain_error("Error: division or modulus by 0");
 		}
-		trim();
+		auto bits = _modulus.size() * uinteger_t::digit_bits;
+		_mu = (uinteger_t::uint_1(_modulus.get_allocator()) << (2 * bits)) / _modulus;
 	}
 
-	template <typename T, std::size_t N>
-	explicit uinteger_t(T (&&s)[N], int base=10) :
-		uinteger_t(s, N - 1, base) { }
+	const uinteger_t& modulus() const {
+		return _modulus;
+	}
 
-	explicit uinteger_t(const unsigned char* bytes, std::size_t sz, int base) :
-		uinteger_t(strtouint(bytes, sz, base)) { }
+	// Reduces x modulo m
+	uinteger_t& reduce(uinteger_t& result, const uinteger_t& x) const {
+		auto n = _modulus.size();
+		if (uinteger_t::compare(x, _modulus) < 0) {
+			result = x;
+			return result;
+		}
+		if (x.size() > 2 * n) {
+			// Out of range for the reciprocal
+			uinteger_t quotient(_modulus.get_allocator());
+			uinteger_t::divmod(quotient, result, x, _modulus);
+			return result;
+		}
 
-	explicit uinteger_t(const char* bytes, std::size_t sz, int base) :
-		uinteger_t(strtouint(bytes, sz, base)) { }
+		// Truncated long multiplications calculate about half of the product,
+		// which beats Karatsuba up to about the Toom-3 cutoff:
+		auto truncated = n <= uinteger_t::toom3_cutoff;
 
-	template <typename T>
-	explicit uinteger_t(const std::vector<T>& bytes, int base=10) :
-		uinteger_t(bytes.data(), bytes.size(), base) { }
+		// Estimate the quotient (the columns below n-1 are not calculated):
+		auto x1 = x >> ((n - 1) * uinteger_t::digit_bits);
+		uinteger_t q(_modulus.get_allocator());
+		if (!truncated) {
+			uinteger_t::mult(q, x1, _mu);
+			q >>= (n + 1) * uinteger_t::digit_bits;
+		} else {
+			uinteger_t::long_mult_high(q, x1, _mu, n - 1);
+			q >>= 2 * uinteger_t::digit_bits;
+		}
+
+		// r = x - q * m, modulo B^(n+1):
+		uinteger_t qm(_modulus.get_allocator());
+		if (!truncated) {
+			qm = uinteger_t::split_piece(q * _modulus, n + 1, 0);
+		} else {
+			uinteger_t::long_mult_low(qm, q, _modulus, n + 1);
+		}
+		auto r = uinteger_t::split_piece(x, n + 1, 0);
+		if (uinteger_t::compare(r, qm) < 0) {
+			r += uinteger_t::uint_1(_modulus.get_allocator()) << ((n + 1) * uinteger_t::digit_bits);
+		}
+		r -= qm;
 
-	explicit uinteger_t(const std::string& bytes, int base=10) :
-		uinteger_t(bytes.data(), bytes.size(), base) { }
+		// Fix up:
+		while (uinteger_t::compare(r, _modulus) >= 0) {
+			r -= _modulus;
+		}
 
-	// Assignment Operator
-	uinteger_t& operator=(const uinteger_t& o) {
-		_begin = 0;
-		_end = 0;
-		_value = container(o.begin(), o.end());
-		_carry = o._carry;
-		return *this;
-	}
-	uinteger_t& operator=(uinteger_t&& o) {
-		_begin = std::move(o._begin);
-		_end = std::move(o._end);
-		_value_instance = std::move(o._value_instance);
-		_carry = std::move(o._carry);
-		return *this;
+		result = std::move(r);
+		return result;
 	}
 
-	// Typecast Operators
-	explicit operator bool() const {
-		return static_cast<bool>(size());
+	uinteger_t reduce(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		reduce(result, x);
+		return result;
 	}
-	explicit operator unsigned char() const {
-		return static_cast<unsigned char>(size() ? front() : 0);
+
+	// Modular multiplication: lhs * rhs mod m (for lhs and rhs less than m)
+	// (the product goes in tmp, a buffer for the caller to reuse)
+	uinteger_t& mod_mul(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs, uinteger_t& tmp) const {
+		uinteger_t::mult(tmp, lhs, rhs);
+		return reduce(result, tmp);
 	}
-	explicit operator unsigned short() const {
-		return static_cast<unsigned short>(size() ? front() : 0);
+
+	uinteger_t& mod_mul(uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) const {
+		uinteger_t tmp(_modulus.get_allocator());
+		return mod_mul(result, lhs, rhs, tmp);
 	}
-	explicit operator unsigned int() const {
-		return static_cast<unsigned int>(size() ? front() : 0);
+
+	uinteger_t mod_mul(const uinteger_t& lhs, const uinteger_t& rhs) const {
+		uinteger_t result(_modulus.get_allocator());
+		mod_mul(result, lhs, rhs);
+		return result;
 	}
-	explicit operator unsigned long() const {
-		return static_cast<unsigned long>(size() ? front() : 0);
+
+	// Modular squaring: x * x mod m (for x less than m)
+	// (the square goes in tmp, a buffer for the caller to reuse)
+	uinteger_t& mod_sqr(uinteger_t& result, const uinteger_t& x, uinteger_t& tmp) const {
+		uinteger_t::sqr(tmp, x);
+		return reduce(result, tmp);
 	}
-	explicit operator unsigned long long() const {
-		return static_cast<unsigned long long>(size() ? front() : 0);
+
+	uinteger_t& mod_sqr(uinteger_t& result, const uinteger_t& x) const {
+		uinteger_t tmp(_modulus.get_allocator());
+		return mod_sqr(result, x, tmp);
 	}
-	explicit operator char() const {
-		return static_cast<char>(size() ? front() : 0);
+
+	uinteger_t mod_sqr(const uinteger_t& x) const {
+		uinteger_t result(_modulus.get_allocator());
+		mod_sqr(result, x);
+		return result;
 	}
-	explicit operator short() const {
-		return static_cast<short>(size() ? front() : 0);
+
+	// Modular exponentiation: base^exp mod m
+	uinteger_t& pow(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp) const {
+		if (!exp) {
+			return reduce(result, uinteger_t::uint_1());
+		}
+
+		// (all the products and squares go through the same buffer)
+		uinteger_t x(_modulus.get_allocator());
+		uinteger_t tmp(_modulus.get_allocator());
+		reduce(x, base);
+		return uinteger_t::sliding_window_pow(result, x, exp,
+			[this, &tmp](uinteger_t& r, const uinteger_t& lhs, const uinteger_t& rhs) { mod_mul(r, lhs, rhs, tmp); },
+			[this, &tmp](uinteger_t& r, const uinteger_t& a) { mod_sqr(r, a, tmp); });
 	}
-	explicit operator int() const {
-		return static_cast<int>(size() ? front() : 0);
+
+	uinteger_t pow(const uinteger_t& base, const uinteger_t& exp) const {
+		uinteger_t result(_modulus.get_allocator());
+		pow(result, base, exp);
+		return result;
 	}
-	explicit operator long() const {
-		return static_cast<long>(size() ? front() : 0);
+};
+
+template <typename Alloc>
+inline basic_uinteger_t<Alloc>& basic_uinteger_t<Alloc>::powmod(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod) {
+	if (!mod) {
+		throw std::domain_error("Error: division or modulus by 0");
 	}
-	explicit operator long long() const {
-		return static_cast<long long>(size() ? front() : 0);
+	if (mod.front() & 1) {
+		return montgomery_context(mod).pow(result, base, exp);
 	}
+	return barrett_context(mod).pow(result, base, exp);
+}
 
-	// Bitwise Operators
-	uinteger_t operator&(const uinteger_t& rhs) const {
-		return bitwise_and(*this, rhs);
+template <typename Alloc>
+inline basic_uinteger_t<Alloc>& basic_uinteger_t<Alloc>::powmod_sec(uinteger_t& result, const uinteger_t& base, const uinteger_t& exp, const uinteger_t& mod) {
+	return montgomery_context(mod).pow_sec(result, base, exp);
+}
+
+template <typename Alloc>
+inline bool basic_uinteger_t<Alloc>::miller_rabin(const montgomery_context& ctx, const uinteger_t& a, const uinteger_t& d, std::size_t s) {
+	const auto& n = ctx.modulus();
+	uinteger_t x(n.get_allocator());
+	ctx.pow(x, a, d);
+	if (x == uint_1() || x == n - uint_1()) {
+		return true;
+	}
+
+	// Squaring (in Montgomery form) until reaching -1:
+	auto one = ctx.one();
+	auto minus_one = n - one;
+	uinteger_t y(n.get_allocator());
+	uinteger_t tmp(n.get_allocator());
+	ctx.to_mont(y, x);
+	for (std::size_t r = 1; r < s; ++r) {
+		ctx.mont_sqr(x, y, tmp);
+		if (x == minus_one) {
+			return true;
+		}
+		if (x == one) {
+			return false;
+		}
+		std::swap(x, y);
 	}
+	return false;
+}
 
-	uinteger_t& operator&=(const uinteger_t& rhs) {
-		return bitwise_and(*this, rhs);
+template <typename Alloc>
+inline bool basic_uinteger_t<Alloc>::strong_lucas(const montgomery_context& ctx, const uinteger_t& D, const uinteger_t& Q) {
+	const auto& n = ctx.modulus();
+	auto add = [&n](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		result = lhs + rhs;
+		if (compare(result, n) >= 0) {
+			result -= n;
+		}
+	};
+	auto sub = [&n](uinteger_t& result, const uinteger_t& lhs, const uinteger_t& rhs) {
+		if (compare(lhs, rhs) >= 0) {
+			result = lhs - rhs;
+		} else {
+			result = lhs + n;
+			result -= rhs;
+		}
+	};
+	auto half = [&n](uinteger_t& x) {
+		if (x.size() && (x.front() & 1)) {
+			x += n;
+		}
+		x >>= 1;
+	};
+
+	// n + 1 = d * 2^s
+	auto d = n + uint_1();
+	std::size_t s = 0;
+	while (!(d.front() & 1)) {
+		d >>= 1;
+		++s;
 	}
+	auto e = d.data();
+	auto bit = [e](std::size_t i) -> digit {
+		return (e[i / digit_bits] >> (i % digit_bits)) & 1;
+	};
 
-	uinteger_t operator|(const uinteger_t& rhs) const {
-		return bitwise_or(*this, rhs);
+	// U(k), V(k) and Q^k, in Montgomery form, from k = 1 up to d, doubling:
+	//   U(2k) = U(k) V(k), V(2k) = V(k)^2 - 2 Q^k
+	// and adding one:
+	//   U(k + 1) = (U(k) + V(k)) / 2, V(k + 1) = (D U(k) + V(k)) / 2
+	auto Dm = ctx.to_mont(D);
+	auto Qm = ctx.to_mont(Q);
+	auto U = ctx.one();
+	auto V = ctx.one();
+	auto Qk = Qm;
+	uinteger_t x(n.get_allocator()), y(n.get_allocator()), tmp(n.get_allocator());
+	for (auto i = d.bits() - 1; i--;) {
+		ctx.mont_mul(x, U, V, tmp);
+		std::swap(U, x);
+		ctx.mont_sqr(x, V, tmp);
+		add(y, Qk, Qk);
+		sub(V, x, y);
+		ctx.mont_sqr(x, Qk, tmp);
+		std::swap(Qk, x);
+		if (bit(i)) {
+			add(x, U, V);
+			half(x);
+			ctx.mont_mul(y, Dm, U, tmp);
+			add(V, y, V);
+			half(V);
+			std::swap(U, x);
+			ctx.mont_mul(x, Qk, Qm, tmp);
+			std::swap(Qk, x);
+		}
+	}
+	if (!U || !V) {
+		return true;
 	}
 
-	uinteger_t& operator|=(const uinteger_t& rhs) {
-		return bitwise_or(*this, rhs);
+	// V(d 2^r), for r < s:
+	for (std::size_t r = 1; r < s; ++r) {
+		ctx.mont_sqr(x, V, tmp);
+		add(y, Qk, Qk);
+		sub(V, x, y);
+		if (!V) {
+			return true;
+		}
+		ctx.mont_sqr(x, Qk, tmp);
+		std::swap(Qk, x);
 	}
+	return false;
+}
 
-	uinteger_t operator^(const uinteger_t& rhs) const {
-		return bitwise_xor(*this, rhs);
+template <typename Alloc>
+inline bool basic_uinteger_t<Alloc>::baillie_psw(const uinteger_t& n, std::size_t rounds) {
+	const montgomery_context ctx(n);
+
+	// n - 1 = d * 2^s
+	auto d = n - uint_1();
+	std::size_t s = 0;
+	while (!(d.front() & 1)) {
+		d >>= 1;
+		++s;
+	}
+	if (!miller_rabin(ctx, uinteger_t(2), d, s)) {
+		return false;
+	}
+
+	// First D in 5, -7, 9, -11, 13... with (D/n) = -1, by reciprocity from
+	// (n/|D|), for which there's none when n is a square:
+	digit a = 5;
+	bool negative = false;
+	while (true) {
+		auto jacobi = _jacobi(single_mod(n, a), a);
+		if ((a & 3) == 3 && (n.front() & 3) == 3) {
+			jacobi = -jacobi;
+		}
+		if (negative && (n.front() & 3) == 3) {
+			jacobi = -jacobi;
+		}
+		if (jacobi == -1) {
+			break;
+		}
+		if (jacobi == 0) {
+			return false;
+		}
+		if (a == 61 && is_perfect_square(n)) {
+			return false;
+		}
+		a += 2;
+		negative = !negative;
+	}
+	auto D = negative ? n - a : uinteger_t(a);
+	auto Q = negative ? uinteger_t((a + 1) / 4) : n - (a - 1) / 4;
+	if (!strong_lucas(ctx, D, Q)) {
+		return false;
 	}
 
-	uinteger_t& operator^=(const uinteger_t& rhs) {
-		return bitwise_xor(*this, rhs);
+	const auto& primes = small_primes().primes;
+	for (std::size_t i = 0; i < rounds && i < primes.size(); ++i) {
+		if (!miller_rabin(ctx, uinteger_t(primes[i]), d, s)) {
+			return false;
+		}
 	}
+	return true;
+}
 
-	uinteger_t operator~() const {
-		return bitwise_inv(*this);
+template <typename Alloc>
+inline void basic_uinteger_t<Alloc>::batch_invmod(uinteger_t* values, std::size_t count, const uinteger_t& mod) {
+	barrett_context ctx(mod);
+	if (!count) {
+		return;
+	}
+
+	// Running products, prefix[i] = values[0] * ... * values[i]:
+	uinteger_t tmp(mod.get_allocator());
+	std::vector<uinteger_t> prefix(count, tmp);
+	for (std::size_t i = 0; i < count; ++i) {
+		ctx.reduce(tmp, values[i]);
+		values[i] = std::move(tmp);
+		if (i) {
+			ctx.mod_mul(prefix[i], prefix[i - 1], values[i]);
+		} else {
+			prefix[i] = values[i];
+		}
 	}
 
-	uinteger_t inv() {
-		return bitwise_inv(*this);
+	// Invert the product of them all, and peel off one value at a time:
+	auto inverse = invmod(prefix[count - 1], mod);
+	for (std::size_t i = count - 1; i; --i) {
+		ctx.mod_mul(tmp, inverse, prefix[i - 1]);
+		ctx.mod_mul(inverse, inverse, values[i]);
+		values[i] = std::move(tmp);
 	}
+	values[0] = std::move(inverse);
+}
 
-	// Bit Shift Operators
-	uinteger_t operator<<(const uinteger_t& rhs) const {
-		return bitwise_lshift(*this, rhs);
+
+// Fixed width unsigned integer
+//
+// Bits bits (a multiple of the digit size) kept in an array of digits, the
+// least significant first, so it never allocates. Arithmetic wraps around
+// modulo 2^Bits like it does for the builtin unsigned types; the loops have a
+// fixed number of steps, for the compiler to unroll. Everything but division
+// and conversion to strings (which go through uinteger_t, which uint_t converts
+// to and from) is constexpr, so constants can be calculated at compile time.
+template <std::size_t Bits>
+class uint_t {
+public:
+	using digit = uinteger_t::digit;
+
+	static constexpr std::size_t digit_bits = uinteger_t::digit_bits;
+	static constexpr std::size_t digits = Bits / digit_bits;  // number of digits
+
+	static_assert(Bits && Bits % digit_bits == 0, "Bits must be a multiple of the size of a digit");
+
+private:
+	digit _value[digits];
+
+	template <typename T>
+	static constexpr bool _negative(const T& value, std::true_type) {
+		return value < 0;
 	}
 
-	uinteger_t& operator<<=(const uinteger_t& rhs) {
-		return bitwise_lshift(*this, rhs);
+	template <typename T>
+	static constexpr bool _negative(const T&, std::false_type) {
+		return false;
 	}
 
-	uinteger_t operator>>(const uinteger_t& rhs) const {
-		return bitwise_rshift(*this, rhs);
+	// Only the products of digits that land in the lowest Bits bits
+	static constexpr uint_t mult(const uint_t& lhs, const uint_t& rhs) {
+		uint_t result;
+		for (std::size_t i = 0; i < digits; ++i) {
+			digit carry = 0;
+			for (std::size_t j = 0; i + j < digits; ++j) {
+				carry = uinteger_t::_multadd(lhs._value[i], rhs._value[j], result._value[i + j], carry, &result._value[i + j]);
+			}
+		}
+		return result;
 	}
 
-	uinteger_t& operator>>=(const uinteger_t& rhs) {
-		return bitwise_rshift(*this, rhs);
+	static constexpr int compare(const uint_t& lhs, const uint_t& rhs) {
+		for (auto i = digits; i--; ) {
+			if (lhs._value[i] != rhs._value[i]) {
+				return lhs._value[i] < rhs._value[i] ? -1 : 1;
+			}
+		}
+		return 0;
 	}
 
-	// Logical Operators
-	bool operator!() const {
-		return !static_cast<bool>(*this);
+public:
+	constexpr uint_t() :
+		_value() { }
+
+	// Negative values wrap around, as they do for the builtin unsigned types
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	constexpr uint_t(const T& value) :
+		_value() {
+		_value[0] = static_cast<digit>(value);
+		for (std::size_t i = 1; i < digits; ++i) {
+			_value[i] = _negative(value, std::is_signed<T>()) ? ~static_cast<digit>(0) : 0;
+		}
 	}
 
-	bool operator&&(const uinteger_t& rhs) const {
-		return static_cast<bool>(*this) && rhs;
+	// Keeps the lowest Bits bits
+	explicit uint_t(const uinteger_t& num) {
+		auto sz = std::min(num.size(), digits);
+		std::copy(num.begin(), num.begin() + sz, _value);
+		std::fill(_value + sz, _value + digits, 0);
+	}
+
+	explicit uint_t(const std::string& bytes, int base = 10) :
+		uint_t(uinteger_t(bytes, base)) { }
+
+	// Value of the characters of an integer literal: decimal, or hexadecimal
+	// (0x), binary (0b) or octal (0) by its prefix, with optional ' separators.
+	// Throws for digits not in the base and for values that don't fit, which
+	// for the literals (below) makes them fail to compile.
+	static constexpr uint_t literal(const char* chars, std::size_t size) {
+		int base = 10;
+		std::size_t i = 0;
+		if (size > 1 && chars[0] == '0') {
+			if (chars[1] == 'x' || chars[1] == 'X') {
+				base = 16;
+				i = 2;
+			} else if (chars[1] == 'b' || chars[1] == 'B') {
+				base = 2;
+				i = 2;
+			} else {
+				base = 8;
+				i = 1;
+			}
+		}
+
+		uint_t result;
+		for (; i < size; ++i) {
+			if (chars[i] == '\'') {
+				continue;
+			}
+			auto d = uinteger_t::ord(chars[i]);
+			if (d < 0 || d >= base) {
+				throw std::invalid_argument("Error: Not a digit in literal");
+			}
+			digit carry = d;
+			for (std::size_t j = 0; j < digits; ++j) {
+				carry = uinteger_t::_multadd(result._value[j], base, 0, carry, &result._value[j]);
+			}
+			if (carry) {
+				throw std::out_of_range("Error: Literal out of range");
+			}
+		}
+		return result;
 	}
 
-	bool operator||(const uinteger_t& rhs) const {
-		return static_cast<bool>(*this) || rhs;
+	explicit operator uinteger_t() const {
+		uinteger_t result;
+		result.resize(digits);
+		std::copy(_value, _value + digits, result.begin());
+		result.trim();
+		return result;
 	}
 
-	// Comparison Operators
-	bool operator==(const uinteger_t& rhs) const {
-		return compare(*this, rhs) == 0;
+	// Typecast Operators
+	constexpr explicit operator bool() const {
+		for (std::size_t i = 0; i < digits; ++i) {
+			if (_value[i]) {
+				return true;
+			}
+		}
+		return false;
 	}
 
-	bool operator!=(const uinteger_t& rhs) const {
-		return compare(*this, rhs) != 0;
+	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
+	constexpr explicit operator T() const {
+		return static_cast<T>(_value[0]);
 	}
 
-	bool operator>(const uinteger_t& rhs) const {
-		return compare(*this, rhs) > 0;
+	constexpr digit* data() noexcept {
+		return _value;
 	}
 
-	bool operator<(const uinteger_t& rhs) const {
-		return compare(*this, rhs) < 0;
+	constexpr const digit* data() const noexcept {
+		return _value;
 	}
 
-	bool operator>=(const uinteger_t& rhs) const {
-		return compare(*this, rhs) >= 0;
+	// Get bitsize of value
+	constexpr std::size_t bits() const {
+		for (auto i = digits; i--; ) {
+			if (_value[i]) {
+				return uinteger_t::_bits(_value[i]) + i * digit_bits;
+			}
+		}
+		return 0;
 	}
 
-	bool operator<=(const uinteger_t& rhs) const {
-		return compare(*this, rhs) <= 0;
+	// Bitwise Operators
+	constexpr uint_t& operator&=(const uint_t& rhs) {
+		for (std::size_t i = 0; i < digits; ++i) {
+			_value[i] &= rhs._value[i];
+		}
+		return *this;
 	}
 
-	// Arithmetic Operators
-	uinteger_t operator+(const uinteger_t& rhs) const {
-		return add(*this, rhs);
+	constexpr uint_t& operator|=(const uint_t& rhs) {
+		for (std::size_t i = 0; i < digits; ++i) {
+			_value[i] |= rhs._value[i];
+		}
+		return *this;
 	}
 
-	uinteger_t& operator+=(const uinteger_t& rhs) {
-		return add(*this, rhs);
+	constexpr uint_t& operator^=(const uint_t& rhs) {
+		for (std::size_t i = 0; i < digits; ++i) {
+			_value[i] ^= rhs._value[i];
+		}
+		return *this;
 	}
 
-	uinteger_t operator-(const uinteger_t& rhs) const {
-		return sub(*this, rhs);
+	constexpr uint_t operator~() const {
+		uint_t result;
+		for (std::size_t i = 0; i < digits; ++i) {
+			result._value[i] = ~_value[i];
+		}
+		return result;
 	}
 
-	uinteger_t& operator-=(const uinteger_t& rhs) {
-		return sub(*this, rhs);
+	// Bit Shift Operators (shifting Bits or more gives zero)
+	constexpr uint_t& operator<<=(std::size_t n) {
+		auto shift = n % digit_bits;
+		auto d = n < Bits ? n / digit_bits : digits;
+		for (auto i = digits; i-- > d; ) {
+			auto v = _value[i - d] << shift;
+			if (shift && i > d) {
+				v |= _value[i - d - 1] >> (digit_bits - shift);
+			}
+			_value[i] = v;
+		}
+		for (std::size_t i = 0; i < d; ++i) {
+			_value[i] = 0;
+		}
+		return *this;
 	}
 
-	uinteger_t operator*(const uinteger_t& rhs) const {
-		return mult(*this, rhs);
+	constexpr uint_t& operator>>=(std::size_t n) {
+		auto shift = n % digit_bits;
+		auto d = n < Bits ? n / digit_bits : digits;
+		for (std::size_t i = 0; i + d < digits; ++i) {
+			auto v = _value[i + d] >> shift;
+			if (shift && i + d + 1 < digits) {
+				v |= _value[i + d + 1] << (digit_bits - shift);
+			}
+			_value[i] = v;
+		}
+		for (auto i = digits - d; i < digits; ++i) {
+			_value[i] = 0;
+		}
+		return *this;
 	}
 
-	uinteger_t& operator*=(const uinteger_t& rhs) {
-		return mult(*this, rhs);
+	// Arithmetic Operators
+	constexpr uint_t& operator+=(const uint_t& rhs) {
+		digit carry = 0;
+		for (std::size_t i = 0; i < digits; ++i) {
+			carry = uinteger_t::_addcarry(_value[i], rhs._value[i], carry, &_value[i]);
+		}
+		return *this;
 	}
 
-	std::pair<uinteger_t, uinteger_t> divmod(const uinteger_t& rhs) const {
-		return divmod(*this, rhs);
+	constexpr uint_t& operator-=(const uint_t& rhs) {
+		digit borrow = 0;
+		for (std::size_t i = 0; i < digits; ++i) {
+			borrow = uinteger_t::_subborrow(_value[i], rhs._value[i], borrow, &_value[i]);
+		}
+		return *this;
 	}
 
-	uinteger_t operator/(const uinteger_t& rhs) const {
-		return divmod(*this, rhs).first;
+	constexpr uint_t& operator*=(const uint_t& rhs) {
+		return *this = *this * rhs;
 	}
 
-	uinteger_t& operator/=(const uinteger_t& rhs) {
-		uinteger_t quotient;
-		uinteger_t remainder;
-		divmod(quotient, remainder, *this, rhs);
-		*this = std::move(quotient);
-		return *this;
+	uint_t& operator/=(const uint_t& rhs) {
+		return *this = *this / rhs;
 	}
 
-	uinteger_t operator%(const uinteger_t& rhs) const {
-		return divmod(*this, rhs).second;
+	uint_t& operator%=(const uint_t& rhs) {
+		return *this = *this % rhs;
 	}
 
-	uinteger_t& operator%=(const uinteger_t& rhs) {
-		uinteger_t quotient;
-		uinteger_t remainder;
-		divmod(quotient, remainder, *this, rhs);
-		*this = std::move(remainder);
+	// Increment and Decrement Operators
+	constexpr uint_t& operator++() {
+		for (std::size_t i = 0; i < digits && !++_value[i]; ++i) { }
 		return *this;
 	}
 
-	// Increment Operator
-	uinteger_t& operator++() {
-		return *this += uint_1();
-	}
-	uinteger_t operator++(int) {
-		uinteger_t temp(*this);
+	constexpr uint_t operator++(int) {
+		uint_t temp(*this);
 		++*this;
 		return temp;
 	}
 
-	// Decrement Operator
-	uinteger_t& operator--() {
-		return *this -= uint_1();
+	constexpr uint_t& operator--() {
+		for (std::size_t i = 0; i < digits && !_value[i]--; ++i) { }
+		return *this;
 	}
-	uinteger_t operator--(int) {
-		uinteger_t temp(*this);
+
+	constexpr uint_t operator--(int) {
+		uint_t temp(*this);
 		--*this;
 		return temp;
 	}
 
-	// Nothing done since promotion doesn't work here
-	uinteger_t operator+() const {
+	constexpr uint_t operator+() const {
 		return *this;
 	}
 
 	// two's complement
-	uinteger_t operator-() const {
-		return uint_0() - *this;
+	constexpr uint_t operator-() const {
+		return uint_t() - *this;
 	}
 
-	// Get private value at index
-	const digit& value(std::size_t idx) const {
-		static const digit zero = 0;
-		return idx < size() ? *(begin() + idx) : zero;
+	friend constexpr uint_t operator&(uint_t lhs, const uint_t& rhs) {
+		return lhs &= rhs;
 	}
 
-	// Get value of bit N
-	bool operator[](std::size_t n) const {
-		auto nd = n / digit_bits;
-		auto nm = n % digit_bits;
-		return nd < size() ? (*(begin() + nd) >> nm) & 1 : 0;
+	friend constexpr uint_t operator|(uint_t lhs, const uint_t& rhs) {
+		return lhs |= rhs;
 	}
 
-	// Get bitsize of value
-	std::size_t bits() const {
-		auto sz = size();
-		if (sz) {
-			return _bits(back()) + (sz - 1) * digit_bits;
-		}
-		return 0;
+	friend constexpr uint_t operator^(uint_t lhs, const uint_t& rhs) {
+		return lhs ^= rhs;
 	}
 
-	// Get string representation of value
-	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
-	Result str(int alphabet_base = 10) const {
-		auto num_sz = size();
-		if (alphabet_base >= 2 && alphabet_base <= 36) {
-			Result result;
-			if (num_sz) {
-				auto alphabet_base_bits = base_bits(alphabet_base);
-				result.reserve(num_sz * base_size(alphabet_base));
-				if (alphabet_base_bits) {
-					digit alphabet_base_mask = alphabet_base - 1;
-					std::size_t shift = 0;
-					auto ptr = reinterpret_cast<const half_digit*>(data());
-					digit v = *ptr++;
-					v <<= half_digit_bits;
-					for (auto i = num_sz * 2 - 1; i; --i) {
-						v >>= half_digit_bits;
-						v |= (static_cast<digit>(*ptr++) << half_digit_bits);
-						do {
-							auto d = static_cast<int>((v >> shift) & alphabet_base_mask);
-							result.push_back(chr(d));
-							shift += alphabet_base_bits;
-						} while (shift <= half_digit_bits);
-						shift -= half_digit_bits;
-					}
-					v >>= (shift + half_digit_bits);
-					while (v) {
-						auto d = static_cast<int>(v & alphabet_base_mask);
-						result.push_back(chr(d));
-						v >>= alphabet_base_bits;
-					}
-					auto s = chr(0);
-					auto rit_f = std::find_if(result.rbegin(), result.rend(), [s](const char& c) { return c != s; });
-					result.resize(result.rend() - rit_f); // shrink
-				} else {
-					uinteger_t uint_base = alphabet_base;
-					uinteger_t quotient = *this;
-					do {
-						auto r = quotient.divmod(uint_base);
-						auto d = static_cast<int>(r.second);
-						result.push_back(chr(d));
-						quotient = std::move(r.first);
-					} while (quotient);
-				}
-				std::reverse(result.begin(), result.end());
-			} else {
-				result.push_back(chr(0));
-			}
-			return result;
-		} else if (alphabet_base == 256) {
-			if (num_sz) {
-				auto ptr = reinterpret_cast<const char*>(data());
-				Result result(ptr, ptr + num_sz * digit_octets);
-				auto rit_f = std::find_if(result.rbegin(), result.rend(), [](const char& c) { return c; });
-				result.resize(result.rend() - rit_f); // shrink
-				std::reverse(result.begin(), result.end());
-				return result;
-			} else {
-				Result result;
-				result.push_back('\x00');
-				return result;
-			}
-		} else {
-			throw std::invalid_argument("Base must be in the range [2, 36]");
-		}
+	friend constexpr uint_t operator<<(uint_t lhs, std::size_t n) {
+		return lhs <<= n;
 	}
 
-	static uinteger_t strtouint(const void* encoded, std::size_t encoded_size, int alphabet_base) {
-		const char* data = (const char *)encoded;
-		uinteger_t result;
-
-		if (alphabet_base >= 2 && alphabet_base <= 36) {
-			uinteger_t alphabet_base_bits = base_bits(alphabet_base);
-			uinteger_t uint_base = alphabet_base;
-			if (alphabet_base_bits) {
-				for (; encoded_size; --encoded_size, ++data) {
-					auto d = ord(static_cast<int>(*data));
-					if (d < 0) {
-						throw std::invalid_argument("Error: Not a digit in base " + std::to_string(alphabet_base) + ": '" + std::string(1, *data) + "' at " + std::to_string(encoded_size));
-					}
-					result = (result << alphabet_base_bits) | d;
-				}
-			} else {
-				for (; encoded_size; --encoded_size, ++data) {
-					auto d = ord(static_cast<int>(*data));
-					if (d < 0) {
-						throw std::invalid_argument("Error: Not a digit in base " + std::to_string(alphabet_base) + ": '" + std::string(1, *data) + "' at " + std::to_string(encoded_size));
-					}
-					result = (result * uint_base) + d;
-				}
-			}
-		} else if (encoded_size && alphabet_base == 256) {
-			auto value_size = encoded_size / digit_octets;
-			auto value_padding = encoded_size % digit_octets;
-			if (value_padding) {
-				value_padding = digit_octets - value_padding;
-				++value_size;
-			}
-			result.resize(value_size); // grow (no initialization)
-			*result.begin() = 0; // initialize value
-			auto ptr = reinterpret_cast<char*>(result.data());
-			std::copy(data, data + encoded_size, ptr + value_padding);
-			std::reverse(ptr, ptr + value_size * digit_octets);
-		} else {
-			throw std::invalid_argument("Error: Cannot convert from base " + std::to_string(alphabet_base));
-		}
-
-		return result;
+	friend constexpr uint_t operator>>(uint_t lhs, std::size_t n) {
+		return lhs >>= n;
 	}
 
-	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
-	Result bin() const {
-		return str<Result>(2);
+	friend constexpr uint_t operator+(uint_t lhs, const uint_t& rhs) {
+		return lhs += rhs;
 	}
 
-	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
-	Result oct() const {
-		return str<Result>(8);
+	friend constexpr uint_t operator-(uint_t lhs, const uint_t& rhs) {
+		return lhs -= rhs;
 	}
 
-	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
-	Result hex() const {
-		return str<Result>(16);
+	friend constexpr uint_t operator*(const uint_t& lhs, const uint_t& rhs) {
+		return mult(lhs, rhs);
 	}
 
-	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
-	Result raw() const {
-		return str<Result>(256);
+	friend uint_t operator/(const uint_t& lhs, const uint_t& rhs) {
+		return uint_t(static_cast<uinteger_t>(lhs) / static_cast<uinteger_t>(rhs));
 	}
-};
 
-namespace std {  // This is probably not a good idea
-	// Make it work with std::string()
-	inline std::string to_string(uinteger_t& num) {
-		return num.str();
-	}
-	inline const std::string to_string(const uinteger_t& num) {
-		return num.str();
+	friend uint_t operator%(const uint_t& lhs, const uint_t& rhs) {
+		return uint_t(static_cast<uinteger_t>(lhs) % static_cast<uinteger_t>(rhs));
 	}
-}
-
-// lhs type T as first arguemnt
-// If the output is not a bool, casts to type T
-
-// Bitwise Operators
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator&(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) & rhs;
-}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator&=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(rhs & lhs);
-}
-
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator|(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) | rhs;
-}
-
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator|=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(rhs | lhs);
-}
-
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator^(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) ^ rhs;
-}
+	// Comparison Operators
+	friend constexpr bool operator==(const uint_t& lhs, const uint_t& rhs) {
+		return compare(lhs, rhs) == 0;
+	}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator^=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(rhs ^ lhs);
-}
+	friend constexpr bool operator!=(const uint_t& lhs, const uint_t& rhs) {
+		return !(lhs == rhs);
+	}
 
-// Bitshift operators
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-inline uinteger_t operator<<(T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) << rhs;
-}
+	friend constexpr bool operator<(const uint_t& lhs, const uint_t& rhs) {
+		return compare(lhs, rhs) < 0;
+	}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator<<=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(lhs << rhs);
-}
+	friend constexpr bool operator>(const uint_t& lhs, const uint_t& rhs) {
+		return compare(lhs, rhs) > 0;
+	}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-inline uinteger_t operator>>(T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) >> rhs;
-}
+	friend constexpr bool operator<=(const uint_t& lhs, const uint_t& rhs) {
+		return compare(lhs, rhs) <= 0;
+	}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator>>=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(lhs >> rhs);
-}
+	friend constexpr bool operator>=(const uint_t& lhs, const uint_t& rhs) {
+		return compare(lhs, rhs) >= 0;
+	}
 
-// Comparison Operators
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator==(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) == rhs;
-}
+	// Get string representation of value
+	template <typename Result = std::string, typename = std::enable_if_t<uinteger_t::is_result<Result>::value>>
+	Result str(int alphabet_base = 10) const {
+		return static_cast<uinteger_t>(*this).template str<Result>(alphabet_base);
+	}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator!=(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) != rhs;
-}
+	friend std::ostream& operator<<(std::ostream& stream, const uint_t& rhs) {
+		return stream << static_cast<uinteger_t>(rhs);
+	}
+};
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator>(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) > rhs;
-}
+template <std::size_t Bits> constexpr std::size_t uint_t<Bits>::digit_bits;
+template <std::size_t Bits> constexpr std::size_t uint_t<Bits>::digits;
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator<(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) < rhs;
-}
+namespace std {  // This is probably not a good idea
+	template <std::size_t Bits>
+	class numeric_limits<uint_t<Bits>> {
+	public:
+		static constexpr bool is_specialized = true;
+		static constexpr bool is_signed = false;
+		static constexpr bool is_integer = true;
+		static constexpr bool is_exact = true;
+		static constexpr bool is_bounded = true;
+		static constexpr bool is_modulo = true;
+		static constexpr int digits = static_cast<int>(Bits);
+		static constexpr int radix = 2;
+
+		static constexpr uint_t<Bits> min() {
+			return uint_t<Bits>();
+		}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator>=(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) >= rhs;
-}
+		static constexpr uint_t<Bits> lowest() {
+			return uint_t<Bits>();
+		}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-bool operator<=(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) <= rhs;
-}
+		static constexpr uint_t<Bits> max() {
+			return ~uint_t<Bits>();
+		}
+	};
 
-// Arithmetic Operators
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator+(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) + rhs;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_specialized;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_signed;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_integer;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_exact;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_bounded;
+	template <std::size_t Bits> constexpr bool numeric_limits<uint_t<Bits>>::is_modulo;
+	template <std::size_t Bits> constexpr int numeric_limits<uint_t<Bits>>::digits;
+	template <std::size_t Bits> constexpr int numeric_limits<uint_t<Bits>>::radix;
 }
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator+=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(rhs + lhs);
-}
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator-(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) - rhs;
-}
+// User-defined literals
+//
+// Fixed width ones (12345_u256, 0xdeadbeef_u128, ...) are calculated at compile
+// time, and _uint ones give a uinteger_t whose digits were, so using big
+// constants doesn't take parsing them when the program runs.
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator-=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(lhs - rhs);
-}
+template <char... Chars>
+struct uint_t_literal {
+	static constexpr char chars[sizeof...(Chars)] = {Chars...};
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator*(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) * rhs;
-}
+	// Enough for any base (4 bits per character), in whole digits
+	static constexpr std::size_t bits = (sizeof...(Chars) * 4 + uinteger_t::digit_bits - 1) / uinteger_t::digit_bits * uinteger_t::digit_bits;
+};
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator*=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(rhs * lhs);
-}
+template <char... Chars> constexpr char uint_t_literal<Chars...>::chars[sizeof...(Chars)];
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator/(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) / rhs;
+template <char... Chars>
+constexpr uint_t<128> operator "" _u128() {
+	constexpr auto value = uint_t<128>::literal(uint_t_literal<Chars...>::chars, sizeof...(Chars));
+	return value;
 }
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator/=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(lhs / rhs);
+template <char... Chars>
+constexpr uint_t<256> operator "" _u256() {
+	constexpr auto value = uint_t<256>::literal(uint_t_literal<Chars...>::chars, sizeof...(Chars));
+	return value;
 }
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-uinteger_t operator%(const T& lhs, const uinteger_t& rhs) {
-	return uinteger_t(lhs) % rhs;
+template <char... Chars>
+constexpr uint_t<512> operator "" _u512() {
+	constexpr auto value = uint_t<512>::literal(uint_t_literal<Chars...>::chars, sizeof...(Chars));
+	return value;
 }
 
-template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value and not std::is_same<T, std::decay_t<uinteger_t>>::value>>
-T& operator%=(T& lhs, const uinteger_t& rhs) {
-	return lhs = static_cast<T>(lhs % rhs);
+template <char... Chars>
+constexpr uint_t<1024> operator "" _u1024() {
+	constexpr auto value = uint_t<1024>::literal(uint_t_literal<Chars...>::chars, sizeof...(Chars));
+	return value;
 }
 
-// IO Operator
-inline std::ostream& operator<<(std::ostream& stream, const uinteger_t& rhs) {
-	if (stream.flags() & stream.oct) {
-		stream << rhs.str(8);
-	} else if (stream.flags() & stream.dec) {
-		stream << rhs.str(10);
-	} else if (stream.flags() & stream.hex) {
-		stream << rhs.str(16);
-	}
-	return stream;
+template <char... Chars>
+uinteger_t operator "" _uint() {
+	using literal = uint_t_literal<Chars...>;
+	static constexpr auto value = uint_t<literal::bits>::literal(literal::chars, sizeof...(Chars));
+	return static_cast<uinteger_t>(value);
 }
 
 #endif